@@ -54,6 +54,64 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 // Most media uses 512-byte sector sizes.
 #define FILEIO_CONFIG_MEDIA_SECTOR_SIZE 		512
 
+// Macro defining the number of sectors in the data sector cache.  Each sector requires FILEIO_CONFIG_MEDIA_SECTOR_SIZE
+// bytes of RAM per data buffer.  Sectors are replaced in least-recently-used order and modified sectors are only
+// written to the media when they are evicted or when the cache is flushed (e.g. by FILEIO_Flush or FILEIO_Close).
+#define FILEIO_CONFIG_DATA_CACHE_SECTORS        1
+
+// Macros defining the number of sectors in the FAT sector cache, and how many of those sectors can hold any given FAT
+// sector (the cache is split into FILEIO_CONFIG_FAT_CACHE_SECTORS / FILEIO_CONFIG_FAT_CACHE_WAYS sets).  Modified FAT
+// sectors are written to every copy of the FAT when they are evicted or when the cache is flushed.  Both values must
+// be less than 256.
+#define FILEIO_CONFIG_FAT_CACHE_SECTORS         1
+#define FILEIO_CONFIG_FAT_CACHE_WAYS            1
+
+// Define FILEIO_CONFIG_CLUSTER_BITMAP_SIZE to keep a bitmap of allocated clusters in RAM for each drive, so free clusters
+// can be found without scanning the FAT.  The value is the size of each bitmap in bytes (a multiple of 4); each byte
+// describes 8 clusters.  If a partition has more clusters than its bitmap can describe, the bitmap covers one window
+// of the FAT at a time and is reloaded from the FAT when that window is full.
+//#define FILEIO_CONFIG_CLUSTER_BITMAP_SIZE       1024
+
+// Define FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE to keep an index of the largest free cluster runs on each drive, which is
+// needed by the run allocation policies (see FILEIO_AllocationPolicySet).  The value is the number of runs in each
+// index (1 to 255); each run uses 8 bytes of RAM.
+//#define FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE    16
+
+// Define FILEIO_CONFIG_DIRECTORY_INDEX_SIZE to keep a hashed index of the file names in the most recently searched
+// directories, so opening a file doesn't require reading its directory from the start.  The value is the number of
+// names the index can hold (1 to 65535); each file uses one name (two if it has a long file name) and each name uses 6
+// bytes of RAM.  A directory with more names than the index can hold is searched directly.
+//#define FILEIO_CONFIG_DIRECTORY_INDEX_SIZE      256
+
+// Define FILEIO_CONFIG_PATH_CACHE_SIZE to remember where the most recently used directories are by name, so opening a
+// file in a subdirectory doesn't require searching each directory in its path.  The value is the number of directories
+// remembered (1 to 255); each uses about 40 bytes of RAM, or about 28 without long file name support.  Directories
+// with long file names of more than 12 characters are always searched for.
+//#define FILEIO_CONFIG_PATH_CACHE_SIZE           16
+
+// Define FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE to remember where the free entries of the most recently written directories
+// are, so creating a file doesn't require reading its directory from the start to find room for the new entries.  The
+// value is the number of directories remembered (1 to 255); each uses about 20 bytes of RAM.
+//#define FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE      8
+
+// Define FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE to remember the cluster chains of the most recently read directories, so
+// reading an entry in a large directory doesn't require following the directory's chain through the FAT.  The value is
+// the number of runs of contiguous clusters remembered for each of 4 directories (1 to 255); each run uses 8 bytes of
+// RAM.  The part of a directory after its last remembered run is found by reading the FAT.
+//#define FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE  8
+
+// Define FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE to keep the path of the current working directory, so
+// FILEIO_DirectoryGetCurrent doesn't have to find each directory in its parent.  The value is the longest path kept, in
+// characters; each character uses 2 bytes of RAM, or 1 without long file name support.  A path that is longer, or that
+// FILEIO_DirectoryChange can't follow by name, is found from the disk the next time it's needed.
+//#define FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE  64
+
+// Define FILEIO_CONFIG_ALLOCATION_WINDOW as the number of clusters FILEIO_Write claims for a file at a time when the file
+// needs a new cluster.  Files that are written at the same time then grow in runs of this many clusters instead of
+// interleaving cluster by cluster.  Claimed clusters that a file doesn't grow into stay allocated until the file is
+// closed.
+//#define FILEIO_CONFIG_ALLOCATION_WINDOW         8
+
 /* *******************************************************************************************************/
 /************** Compiler options to enable/Disable Features based on user's application ******************/
 /* *******************************************************************************************************/
@@ -1278,6 +1278,90 @@ bool FILEIO_SD_SectorWrite(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sectorAddre
 }    
 
 
+bool FILEIO_SD_SectorReadMulti(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sectorAddress, uint32_t sectorCount, uint8_t* buffer)
+{
+    FILEIO_SD_ASYNC_IO info;
+    uint8_t status;
+
+    //Initialize info structure to read all of the sectors in one multi-block
+    //read operation, one sector worth of data per packet.
+    info.wNumBytes = 512;
+    info.dwBytesRemaining = sectorCount << 9;
+    info.pBuffer = buffer;
+    info.dwAddress = sectorAddress;
+    info.bStateVariable = FILEIO_SD_ASYNC_READ_QUEUED;
+
+    //Blocking loop, until the state machine finishes reading the sectors,
+    //or a timeout or other error occurs.
+    while(1)
+    {
+        status = FILEIO_SD_AsyncReadTasks(config, &info);
+        if(status == FILEIO_SD_ASYNC_READ_NEW_PACKET_READY)
+        {
+            //The next call will copy a packet to info.pBuffer.  Advance the
+            //pointer for the packet after it.
+            info.pBuffer = buffer;
+            buffer += 512;
+        }
+        else if(status == FILEIO_SD_ASYNC_READ_COMPLETE)
+        {
+            return true;
+        }
+        else if(status == FILEIO_SD_ASYNC_READ_ERROR)
+        {
+            return false;
+        }
+    }
+
+    //Impossible to get here, but we will return a value anyay to avoid possible 
+    //compiler warnings.
+    return false;
+}
+
+
+bool FILEIO_SD_SectorWriteMulti(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sectorAddress, uint32_t sectorCount, uint8_t* buffer)
+{
+    static FILEIO_SD_ASYNC_IO info;
+    uint8_t status;
+
+    //Never allow the MBR to be overwritten by a multi-block write.
+    if(sectorAddress == 0x00000000)
+    {
+        return false;
+    }
+
+    //Initialize structure so we write all of the sectors in one multi-block
+    //write operation, one sector worth of data per packet.
+    info.wNumBytes = 512;
+    info.dwBytesRemaining = sectorCount << 9;
+    info.pBuffer = buffer;
+    info.dwAddress = sectorAddress;
+    info.bStateVariable = FILEIO_SD_ASYNC_WRITE_QUEUED;
+
+    //Repeatedly call the write handler until the operation is complete (or a
+    //failure/timeout occurred).
+    while(1)
+    {
+        status = FILEIO_SD_AsyncWriteTasks(config, &info);
+        if(status == FILEIO_SD_ASYNC_WRITE_SEND_PACKET)
+        {
+            //The next call will send the packet at info.pBuffer.  Advance the
+            //pointer for the packet after it.
+            info.pBuffer = buffer;
+            buffer += 512;
+        }
+        else if(status == FILEIO_SD_ASYNC_WRITE_COMPLETE)
+        {
+            return true;
+        }
+        else if(status == FILEIO_SD_ASYNC_WRITE_ERROR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool FILEIO_SD_WriteProtectStateGet(FILEIO_SD_DRIVE_CONFIG * config)
 {
     return (*config->wpFunc)();
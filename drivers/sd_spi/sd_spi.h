@@ -454,6 +454,68 @@ bool FILEIO_SD_SectorRead(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sector_addr,
   ***************************************************************************************/
 bool FILEIO_SD_SectorWrite(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sector_addr, uint8_t * buffer, bool allowWriteToZero);
 
+/*****************************************************************************
+  Function:
+    bool FILEIO_SD_SectorReadMulti (FILEIO_SD_DRIVE_CONFIG * config,
+        uint32_t sector_addr, uint32_t sectorCount, uint8_t * buffer)
+  Summary:
+    Reads consecutive sectors of data from an SD card.
+  Conditions:
+    The FILEIO_SD_SectorReadMulti function pointer must be pointing towards
+    this function.
+  Input:
+    config - An SD Drive configuration structure pointer
+    sector_addr - The address of the first sector on the card.
+    sectorCount - The number of sectors to read.
+    buffer -      The buffer where the retrieved data will be stored.  It
+                  must be large enough to hold sectorCount sectors.
+  Return Values:
+    true -  The sectors were read successfully
+    false - The sectors could not be read
+  Side Effects:
+    None
+  Description:
+    The FILEIO_SD_SectorReadMulti function reads sectorCount sectors (512
+    bytes each) from the SD card starting at the sector address and stores
+    them in the location pointed to by 'buffer.'  All of the sectors are
+    transferred with a single multi-block read command (CMD18).
+  Remarks:
+    This function performs a synchronous read operation.  It will not return
+    until either the data has fully been read, or, a timeout or other error
+    occurred.
+  ***************************************************************************************/
+bool FILEIO_SD_SectorReadMulti(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sector_addr, uint32_t sectorCount, uint8_t * buffer);
+
+/*****************************************************************************
+  Function:
+    bool FILEIO_SD_SectorWriteMulti (FILEIO_SD_DRIVE_CONFIG * config,
+        uint32_t sector_addr, uint32_t sectorCount, uint8_t * buffer)
+  Summary:
+    Writes consecutive sectors of data to an SD card.
+  Conditions:
+    The FILEIO_SD_SectorWriteMulti function pointer must be pointing to this
+    function.
+  Input:
+    config - An SD Drive configuration structure pointer
+    sector_addr - The address of the first sector on the card.
+    sectorCount - The number of sectors to write.
+    buffer -      The buffer with sectorCount sectors of data to write.
+  Return Values:
+    true -  The sectors were written successfully.
+    false - The sectors could not be written.
+  Side Effects:
+    None.
+  Description:
+    The FILEIO_SD_SectorWriteMulti function writes sectorCount sectors (512
+    bytes each) from the location pointed to by 'buffer' to the SD card,
+    starting at the specified sector.  All of the sectors are transferred
+    with a single multi-block write command (CMD25), after telling the card
+    how many blocks to pre-erase.
+  Remarks:
+    Writes that start at sector 0 (the MBR) always fail.
+  ***************************************************************************************/
+bool FILEIO_SD_SectorWriteMulti(FILEIO_SD_DRIVE_CONFIG * config, uint32_t sector_addr, uint32_t sectorCount, uint8_t * buffer);
+
 /*******************************************************************************
   Function:
     uint8_t FILEIO_SD_WriteProtectStateGet
@@ -128,9 +128,32 @@ typedef enum
     FILEIO_OPEN_WRITE = 0x02,           // Open the file for writing.
     FILEIO_OPEN_CREATE = 0x04,          // Create the file if it doesn't exist.
     FILEIO_OPEN_TRUNCATE = 0x08,        // Truncate the file to 0-length.
-    FILEIO_OPEN_APPEND = 0x10           // Set the current read/write location in the file to the end of the file.
+    FILEIO_OPEN_APPEND = 0x10,          // Set the current read/write location in the file to the end of the file.
+    FILEIO_OPEN_REWRITE = 0x20          // Overwrite the file through its existing cluster chain; the unused part of the chain is freed on close.
 } FILEIO_OPEN_ACCESS_MODES;
 
+// Enumeration of options for FILEIO_Preallocate
+typedef enum
+{
+    FILEIO_PREALLOCATE_CONTIGUOUS = 0x01,   // Fail unless the new clusters can be allocated as a single contiguous run.
+    FILEIO_PREALLOCATE_EXTEND_SIZE = 0x02   // Set the file's size to the preallocated size.
+} FILEIO_PREALLOCATE_FLAGS;
+
+// Enumeration of policies used to choose the clusters allocated to a file or directory as it grows
+typedef enum
+{
+    FILEIO_ALLOCATION_NEXT_FIT = 0,         // Use the first free cluster after the last cluster allocated on the drive.
+    FILEIO_ALLOCATION_FIRST_FIT_RUN,        // Extend the chain in place if possible, otherwise start the lowest free run that fits.
+    FILEIO_ALLOCATION_BEST_FIT_RUN          // Extend the chain in place if possible, otherwise start the smallest free run that fits.
+} FILEIO_ALLOCATION_POLICY;
+
+// Enumeration of modes that control when the secondary copies of the FAT are updated
+typedef enum
+{
+    FILEIO_FAT_MIRRORING_IMMEDIATE = 0,     // Write every change to the FAT to all of its copies.
+    FILEIO_FAT_MIRRORING_DEFERRED           // Keep only the first copy current; copy changed sectors to the others at sync points.
+} FILEIO_FAT_MIRRORING;
+
 // Enumeration of macros defining possible file system types supported by a device
 typedef enum
 {
@@ -140,6 +163,16 @@ typedef enum
     FILEIO_FILE_SYSTEM_TYPE_FAT32           // The device is formatted with FAT32
 } FILEIO_FILE_SYSTEM_TYPE;
 
+// Summary: Describes a run of contiguous clusters in a file.
+// Description: An array of FILEIO_EXTENT structures can be attached to an open file with FILEIO_ExtentMapSet.  The library records the
+//              file's cluster chain in the array as it follows the chain, so later seeks can locate a cluster without reading the FAT.
+typedef struct
+{
+    uint32_t        fileCluster;        // Index of the first cluster of the run within the file
+    uint32_t        diskCluster;        // First cluster of the run on the disk
+    uint32_t        length;             // Number of clusters in the run
+} FILEIO_EXTENT;
+
 // Summary: Contains file information and is used to indicate which file to access.
 // Description: The FILEIO_OBJECT structure is used to hold file information for an open file as it's being modified or accessed.  A pointer to
 //              an open file's FILEIO_OBJECT structure will be passed to any library function that will modify that file.
@@ -151,7 +184,12 @@ typedef struct
     uint32_t        currentCluster;     // The current cluster of the file
     uint32_t        size;               // The size of the file
     uint32_t        absoluteOffset;     // The absolute offset in the file
+    uint32_t        windowStart;        // Index of the first cluster claimed ahead of the file's data by FILEIO_Write
+    uint32_t        windowEnd;          // Index one past the last cluster claimed ahead of the file's data
     void *          disk;               // Pointer to a device structure
+    FILEIO_EXTENT * extentMap;          // Cluster extent map of the file, or NULL (see FILEIO_ExtentMapSet)
+    uint16_t        extentMapSize;      // Number of entries in the extent map
+    uint16_t        extentCount;        // Number of extent map entries in use
     uint16_t        currentSector;      // The current sector in the current cluster of the file
     uint16_t        currentOffset;      // The position in the current sector
     uint16_t        entry;              // The position of the file's directory entry in its directory
@@ -164,6 +202,7 @@ typedef struct
     {
         unsigned    writeEnabled :1;    // Indicates a file was opened in a mode that allows writes
         unsigned    readEnabled :1;     // Indicates a file was opened in a mode that allows reads
+        unsigned    truncateOnClose :1; // Indicates the file's chain should be cut to its size when it is closed (FILEIO_OPEN_REWRITE)
 
     } flags;
 } FILEIO_OBJECT;
@@ -334,6 +373,73 @@ typedef bool (*FILEIO_DRIVER_SectorRead)(void * mediaConfig, uint32_t sector_add
 ***************************************************************************/
 typedef uint8_t (*FILEIO_DRIVER_SectorWrite)(void * mediaConfig, uint32_t sector_addr, uint8_t* buffer, bool allowWriteToZero);
 
+/***************************************************************************
+    Function:
+        bool (*FILEIO_DRIVER_SectorReadMulti)(void * mediaConfig,
+            uint32_t sectorAddress, uint32_t sectorCount, uint8_t * buffer);
+
+    Summary:
+        Function pointer prototype for an optional driver function to read
+        a run of consecutive sectors from the device.
+
+    Description:
+        Function pointer prototype for an optional driver function to read
+        a run of consecutive sectors from the device in a single transfer.
+        Drivers that can't do multi-sector transfers may leave this
+        pointer NULL; the library will read one sector at a time with the
+        FILEIO_DRIVER_SectorRead function instead.
+
+    Precondition:
+        The device will be initialized.
+
+    Parameters:
+        mediaConfig - Pointer to a driver-defined config structure
+        sectorAddress - The address of the first sector to read.  This
+            address format depends on the media.
+        sectorCount - The number of sectors to read.
+        buffer - A buffer to store the data.  It must be large enough to
+            hold sectorCount sectors.
+
+    Returns:
+        If Success: true
+        If Failure: false
+***************************************************************************/
+typedef bool (*FILEIO_DRIVER_SectorReadMulti)(void * mediaConfig, uint32_t sector_addr, uint32_t sectorCount, uint8_t* buffer);
+
+/***************************************************************************
+    Function:
+        bool (*FILEIO_DRIVER_SectorWriteMulti)(void * mediaConfig,
+            uint32_t sectorAddress, uint32_t sectorCount, uint8_t * buffer);
+
+    Summary:
+        Function pointer prototype for an optional driver function to write
+        a run of consecutive sectors to the device.
+
+    Description:
+        Function pointer prototype for an optional driver function to write
+        a run of consecutive sectors to the device in a single transfer.
+        Drivers that can't do multi-sector transfers may leave this
+        pointer NULL; the library will write one sector at a time with the
+        FILEIO_DRIVER_SectorWrite function instead.  The library never
+        uses this function to write the master boot record, so it should
+        fail any write that includes sector 0.
+
+    Precondition:
+        The device will be initialized.
+
+    Parameters:
+        mediaConfig - Pointer to a driver-defined config structure
+        sectorAddress - The address of the first sector to write.  This
+            address format depends on the media.
+        sectorCount - The number of sectors to write.
+        buffer - A buffer containing sectorCount sectors of data to write.
+
+    Returns:
+        If Success: true
+        If Failure: false
+***************************************************************************/
+typedef bool (*FILEIO_DRIVER_SectorWriteMulti)(void * mediaConfig, uint32_t sector_addr, uint32_t sectorCount, uint8_t* buffer);
+
 /***************************************************************************
     Function:
         bool (*FILEIO_DRIVER_WriteProtectStateGet)(void * mediaConfig);
@@ -369,6 +475,8 @@ typedef struct
     FILEIO_DRIVER_SectorRead funcSectorRead;                        // Function to read a sector of the media.
     FILEIO_DRIVER_SectorWrite funcSectorWrite;                      // Function to write a sector of the media.
     FILEIO_DRIVER_WriteProtectStateGet funcWriteProtectGet;         // Function to determine if the media is write-protected.
+    FILEIO_DRIVER_SectorReadMulti funcSectorReadMulti;              // Optional function to read consecutive sectors of the media (may be NULL).
+    FILEIO_DRIVER_SectorWriteMulti funcSectorWriteMulti;            // Optional function to write consecutive sectors of the media (may be NULL).
 } FILEIO_DRIVE_CONFIG;
 
 // Structure that contains the disk search information, intermediate values, and results
@@ -399,6 +507,31 @@ typedef struct
 
 } FILEIO_DRIVE_PROPERTIES;
 
+// Status of an incremental file removal (see FILEIO_RemoveIncremental)
+typedef enum
+{
+    FILEIO_REMOVE_COMPLETE = 0,         // The file has been removed and all of its clusters have been freed.
+    FILEIO_REMOVE_FAILED,               // The removal failed.  The error can be retrieved with FILEIO_ErrorGet.
+    FILEIO_REMOVE_STILL_WORKING = 0xFF  // The file's directory entry has been removed, but some of its clusters haven't been freed yet.
+} FILEIO_REMOVE_STATUS;
+
+// Structure that holds the progress of an incremental file removal
+typedef struct
+{
+    bool    new_request;            /* set to true to start removing a file */
+    FILEIO_REMOVE_STATUS status;    /* status of the last call of FILEIO_RemoveIncremental */
+    uint32_t clusters_freed;        /* the number of clusters freed so far */
+
+    struct
+    {
+        void *      disk;           /* the drive the file was on */
+        uint32_t    cluster;        /* the next cluster of the file's chain to free */
+    } private;      /* intermediate values used to continue a removal.  This
+                         member should be used only by the FILEIO_RemoveIncremental()
+                         function */
+
+} FILEIO_REMOVE_STATE;
+
 // Structure to describe a FAT file system date
 typedef union
 {
@@ -450,6 +583,29 @@ typedef struct
     char driveId;
 } FILEIO_SEARCH_RECORD;
 
+// Directory read record
+typedef struct
+{
+    uint8_t shortFileName[13];          // The name of the entry (NULL-terminated).
+    uint8_t attributes;                 // The attributes of the entry.
+    uint32_t fileSize;                  // The size of the file (bytes).
+    uint32_t firstCluster;              // The first cluster of the entry's data (0 if no data has been allocated).
+    FILEIO_TIMESTAMP createTime;        // The create time of the entry.
+    FILEIO_TIMESTAMP writeTime;         // The last write time of the entry (the millisecond portion is always 0).
+    FILEIO_DATE accessDate;             // The last access date of the entry.
+} FILEIO_DIRECTORY_RECORD;
+
+// Directory read structure
+typedef struct
+{
+    // Private Parameters
+    uint32_t baseDirCluster;
+    uint32_t currentDirCluster;
+    uint16_t currentClusterOffset;
+    uint16_t currentEntryOffset;
+    char driveId;
+} FILEIO_DIRECTORY_OBJECT;
+
 /***************************************************************************
 * Prototypes                                                               *
 ***************************************************************************/
@@ -700,6 +856,71 @@ int FILEIO_DriveUnmount (const char driveId);
   ******************************************************************************/
 int FILEIO_Remove (const char * pathName);
 
+/******************************************************************************
+  Function:
+      int FILEIO_RemoveIncremental (const char * pathName, FILEIO_REMOVE_STATE * state, uint32_t budget)
+    
+  Summary:
+    Deletes a file in bounded steps.
+  Description:
+    Deletes a file like FILEIO_Remove, but frees its clusters over several 
+    calls, so that deleting a large file doesn't block the application for 
+    the whole time it takes to free its cluster chain.
+
+    To start removing a file, set the new_request member of state to true 
+    and call this function.  The first call removes the file's directory 
+    entry and writes it to the media, then frees up to 'budget' clusters.  
+    While state->status is FILEIO_REMOVE_STILL_WORKING, call the function 
+    again with the same state to free up to 'budget' more clusters; the 
+    pathName parameter is ignored on these calls.  Continuing a removal 
+    that isn't FILEIO_REMOVE_STILL_WORKING fails with 
+    FILEIO_ERROR_INVALID_ARGUMENT without changing anything.
+
+    A budget of 0 is rejected with FILEIO_ERROR_INVALID_ARGUMENT without 
+    changing anything either; a removal in progress stays 
+    FILEIO_REMOVE_STILL_WORKING and can be continued with a valid budget.
+
+    The directory entry is removed before any cluster is freed, and the 
+    FAT is written to the media at the end of every call.  If the removal 
+    is interrupted (for example, by a reset or by unmounting the drive), 
+    the clusters that haven't been freed yet are lost until the volume is 
+    checked, but no file can refer to them.
+
+    Typical Usage:
+    <code>
+    FILEIO_REMOVE_STATE removeState;
+
+    removeState.new_request = true;
+
+    do
+    {
+        FILEIO_RemoveIncremental (pathName, &removeState, 64);
+        // Do other work
+    } while (removeState.status == FILEIO_REMOVE_STILL_WORKING);
+    </code>
+  Conditions:
+    The file's drive must be mounted and the file should exist.  The drive 
+    must stay mounted until the removal is complete.
+  Input:
+    pathName -  The path/name of the file.
+    state - The progress of the removal.
+    budget - The maximum number of clusters to free in this call.  Must 
+             not be 0.
+  Return:
+      * If Success: FILEIO_RESULT_SUCCESS.  state->status is 
+        FILEIO_REMOVE_COMPLETE or FILEIO_REMOVE_STILL_WORKING.
+      * If Failure: FILEIO_RESULT_FAILURE.  state->status is 
+        FILEIO_REMOVE_FAILED, unless the call was rejected because of the 
+        budget or the state, in which case state is unchanged.
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet.  The 
+        errors are the same as those of FILEIO_Remove, and:
+        * FILEIO_ERROR_INVALID_ARGUMENT - The budget is 0, the removal 
+          isn't in progress, or the file's cluster chain is invalid.
+        * FILEIO_ERROR_WRITE - The FAT could not be written to the device.
+  ******************************************************************************/
+int FILEIO_RemoveIncremental (const char * pathName, FILEIO_REMOVE_STATE * state, uint32_t budget);
+
 /*******************************************************************************
   Function:
       int FILEIO_Rename (const char * oldPathname, const char * newFilename)
@@ -897,6 +1118,11 @@ void FILEIO_ErrorClear (char driveId);
     pathName -  The path/name of the file to open.
     mode -      The mode in which the file should be opened. Specified by
                 inclusive or'ing parameters from FILEIO_OPEN_ACCESS_MODES.
+                FILEIO_OPEN_REWRITE opens an existing file with a size of 0
+                but keeps its cluster chain; data written to the file reuses
+                the chain, and the clusters it doesn't reach are freed when
+                the file is closed.  FILEIO_OPEN_REWRITE must be combined
+                with FILEIO_OPEN_WRITE.
   Return:
       * If Success: FILEIO_RESULT_SUCCESS
       * If Failure: FILEIO_RESULT_FAILURE
@@ -905,7 +1131,8 @@ void FILEIO_ErrorClear (char driveId);
         that if the path cannot be resolved, the error will be returned for the
         current working directory.
         * FILEIO_ERROR_INVALID_ARGUMENT - The path could not be
-          resolved.
+          resolved, or FILEIO_OPEN_REWRITE was used without
+          FILEIO_OPEN_WRITE.
         * FILEIO_ERROR_WRITE_PROTECTED - The device is write protected
           or this function was called in a write/create mode when writes are
           disabled in configuration.
@@ -943,6 +1170,10 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const char * pathName, uint16_t mode);
         make the memory used to allocate a file available to open other 
         files.
 
+        Clusters that FILEIO_Write claimed for the file ahead of its data 
+        (see FILEIO_CONFIG_ALLOCATION_WINDOW) and that the file didn't grow 
+        into are freed.
+
     Precondition:
         The drive containing the file must be mounted and the file handle 
         must represent a valid, opened file.
@@ -958,6 +1189,8 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const char * pathName, uint16_t mode);
         * FILEIO_ERROR_WRITE - Data could not be written to the device.
         * FILEIO_ERROR_BAD_CACHE_READ - The file's directory entry
           could not be cached.                                             
+        * FILEIO_ERROR_BAD_SECTOR_READ - The FAT could not be read while 
+          freeing the unused clusters.
 ***************************************************************************/
 int FILEIO_Close (FILEIO_OBJECT * handle);
 
@@ -1155,7 +1388,9 @@ size_t FILEIO_Write (const void * buffer, size_t size, size_t count, FILEIO_OBJE
         Changes the current read/write position in the file.
 
     Description:
-        Changes the current read/write position in the file.
+        Changes the current read/write position in the file.  The data at
+        the new position is not read from the device until the next call to
+        FILEIO_Read or FILEIO_Write needs it.
 
     Precondition:
         The drive containing the file must be mounted and the file handle 
@@ -1178,8 +1413,7 @@ size_t FILEIO_Write (const void * buffer, size_t size, size_t count, FILEIO_OBJE
         * FILEIO_ERROR_INVALID_ARGUMENT - The specified location
           exceeds the file's size.
         * FILEIO_ERROR_BAD_SECTOR_READ - There was an error reading the
-          FAT to determine the next cluster in the file, or an error reading the
-          file data.
+          FAT to determine the next cluster in the file.
         * FILEIO_ERROR_INVALID_CLUSTER - The next cluster in the file
           is invalid.
         * FILEIO_ERROR_DRIVE_FULL - There are no more clusters on the
@@ -1216,6 +1450,257 @@ int FILEIO_Seek (FILEIO_OBJECT * handle, int32_t offset, int base);
   *************************************************************************/
 bool FILEIO_Eof (FILEIO_OBJECT * handle);
 
+/***************************************************************************
+  Function:
+    void FILEIO_ExtentMapSet (FILEIO_OBJECT * handle, FILEIO_EXTENT * extentMap, uint16_t size)
+
+    Summary:
+        Attaches a cluster extent map to an open file.
+
+    Description:
+        Attaches an array of FILEIO_EXTENT structures to an open file.  As the 
+        library follows the file's cluster chain it records each run of 
+        contiguous clusters in the array, and FILEIO_Seek, FILEIO_Read and 
+        FILEIO_Write use the recorded runs to find a cluster without reading 
+        the FAT.  Once the array is full, clusters past the last recorded run 
+        are found by following the FAT from the end of that run.
+
+        The map is detached when the file is opened again.  Passing a NULL 
+        map or a size of 0 detaches the current map.
+
+    Precondition:
+        The drive containing the file must be mounted and the file handle 
+        must represent a valid, opened file.
+
+    Parameters:
+        handle - The handle of the file.
+        extentMap - Array that will hold the extent map.  It must remain 
+            valid while the file is open.
+        size - The number of entries in extentMap.
+
+    Returns:
+        None
+***************************************************************************/
+void FILEIO_ExtentMapSet (FILEIO_OBJECT * handle, FILEIO_EXTENT * extentMap, uint16_t size);
+
+/***************************************************************************
+  Function:
+    int FILEIO_Preallocate (FILEIO_OBJECT * handle, uint32_t bytes, uint8_t flags)
+
+    Summary:
+        Allocates the clusters a file will need before it is written.
+
+    Description:
+        Extends the file's cluster chain so that it can hold 'bytes' bytes.  
+        The library looks for a run of free clusters large enough for all of 
+        the new clusters, starting right after the end of the file's current 
+        chain, and links it to the file.  If there is no such run the largest 
+        free run is used and the rest of the clusters are allocated one at a 
+        time, unless FILEIO_PREALLOCATE_CONTIGUOUS is specified.  FILEIO_Write 
+        and FILEIO_Seek will then use the allocated clusters without doing 
+        any allocation work of their own.
+
+        The FAT and the file's directory entry are written to the device 
+        before the function returns.  The file's size is left unchanged 
+        unless FILEIO_PREALLOCATE_EXTEND_SIZE is specified; in that case the 
+        contents of the file past its old size are undefined.  Clusters past 
+        the end of the file remain allocated to it until the file is removed 
+        or truncated.
+
+    Precondition:
+        The drive containing the file must be mounted and the file handle 
+        must represent a valid, opened file.
+
+    Parameters:
+        handle - The handle of the file.
+        bytes - The number of bytes the file's clusters should be able to 
+            hold.  Nothing is allocated if the file already has enough 
+            clusters.
+        flags - Options, specified by inclusive or'ing parameters from 
+            FILEIO_PREALLOCATE_FLAGS.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_READ_ONLY - The file was not opened in write mode.
+        * FILEIO_ERROR_WRITE_PROTECTED - The media is write-protected.
+        * FILEIO_ERROR_BAD_SECTOR_READ - There was an error reading the
+          FAT.
+        * FILEIO_ERROR_INVALID_CLUSTER - The file's cluster chain is 
+          invalid.
+        * FILEIO_ERROR_WRITE - The FAT or the directory entry could not be 
+          written to the device.
+        * FILEIO_ERROR_DRIVE_FULL - There are not enough free clusters on 
+          the media, or FILEIO_PREALLOCATE_CONTIGUOUS was specified and 
+          there is no free run large enough.
+  *****************************************************************************/
+int FILEIO_Preallocate (FILEIO_OBJECT * handle, uint32_t bytes, uint8_t flags);
+
+/***************************************************************************
+  Function:
+    int FILEIO_Truncate (FILEIO_OBJECT * handle, uint32_t newSize)
+
+    Summary:
+        Shortens a file.
+
+    Description:
+        Sets the size of the file to 'newSize' and frees the clusters of its 
+        chain that are no longer needed.  The chain is cut after the cluster 
+        that holds the last byte of the file; the clusters before it are not 
+        touched.  The new size is written to the file's directory entry 
+        before any cluster is freed.  If the current read/write location was 
+        past the new end of the file it is moved to the end of the file.
+
+        To replace the contents of a file without freeing and allocating its 
+        clusters again, open it with FILEIO_OPEN_REWRITE instead.
+
+    Precondition:
+        The drive containing the file must be mounted and the file handle 
+        must represent a valid, opened file.
+
+    Parameters:
+        handle - The handle of the file.
+        newSize - The new size of the file.  It must not be larger than the 
+            current size.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_READ_ONLY - The file was not opened in write mode.
+        * FILEIO_ERROR_WRITE_PROTECTED - The media is write-protected.
+        * FILEIO_ERROR_INVALID_ARGUMENT - newSize is larger than the file.
+        * FILEIO_ERROR_BAD_SECTOR_READ - There was an error reading the
+          FAT.
+        * FILEIO_ERROR_INVALID_CLUSTER - The file's cluster chain is 
+          invalid.
+        * FILEIO_ERROR_WRITE - The FAT or the directory entry could not be 
+          written to the device.
+  *****************************************************************************/
+int FILEIO_Truncate (FILEIO_OBJECT * handle, uint32_t newSize);
+
+/***************************************************************************
+  Function:
+    int FILEIO_AllocationPolicySet (char driveId, FILEIO_ALLOCATION_POLICY policy)
+
+    Summary:
+        Selects how new clusters are chosen on a drive.
+
+    Description:
+        Selects the policy used to choose a free cluster when a file or 
+        directory on the drive grows.  FILEIO_ALLOCATION_NEXT_FIT, the 
+        default, takes the first free cluster after the last one allocated 
+        on the drive, so files that are written at the same time end up 
+        interleaved.
+
+        The run policies allocate the cluster that follows the end of the 
+        chain whenever it is free.  When it isn't, they start a new run in 
+        a free extent large enough for the rest of the current write: the 
+        lowest one with FILEIO_ALLOCATION_FIRST_FIT_RUN, or the smallest one 
+        with FILEIO_ALLOCATION_BEST_FIT_RUN.  If no extent is large enough, 
+        the largest one is used.  Free extents are looked up in an index of 
+        the largest free runs on the drive, which is built from the FAT the 
+        first time it is needed and rebuilt when all of its runs have been 
+        used up.
+
+        The run policies are only available if 
+        FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE is defined.  The policy is 
+        reset to FILEIO_ALLOCATION_NEXT_FIT whenever the drive is mounted.
+
+    Precondition:
+        The drive must be mounted.
+
+    Parameters:
+        driveId - Character representation of the mounted device.
+        policy - The allocation policy to use.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_INVALID_ARGUMENT - The policy is not supported by 
+          this configuration of the library.
+  *****************************************************************************/
+int FILEIO_AllocationPolicySet (char driveId, FILEIO_ALLOCATION_POLICY policy);
+
+/***************************************************************************
+  Function:
+    int FILEIO_FATMirroringSet (char driveId, FILEIO_FAT_MIRRORING mode)
+
+    Summary:
+        Selects when the secondary copies of the FAT are updated.
+
+    Description:
+        Most FAT volumes keep two copies of the File Allocation Table.  With 
+        FILEIO_FAT_MIRRORING_IMMEDIATE, the default, every FAT sector the 
+        library writes back is written to each copy, which doubles the 
+        number of FAT writes.
+
+        With FILEIO_FAT_MIRRORING_DEFERRED only the first copy is kept 
+        current.  The library remembers which of its sectors have changed 
+        and copies them to the other copies, in ascending order, when 
+        FILEIO_Flush, FILEIO_Close, FILEIO_Sync or FILEIO_DriveUnmount is 
+        called.  If the media is removed between those points, the 
+        secondary copies may be out of date; the first copy, which is the 
+        one used by the library and by most operating systems, is not 
+        affected.
+
+        Switching back to FILEIO_FAT_MIRRORING_IMMEDIATE brings the 
+        secondary copies up to date.  The mode is reset to 
+        FILEIO_FAT_MIRRORING_IMMEDIATE whenever the drive is mounted.
+
+    Precondition:
+        The drive must be mounted.
+
+    Parameters:
+        driveId - Character representation of the mounted device.
+        mode - The mirroring mode to use.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_INVALID_ARGUMENT - The mode is not valid.
+        * FILEIO_ERROR_WRITE - The secondary copies of the FAT could not be 
+          brought up to date.
+  *****************************************************************************/
+int FILEIO_FATMirroringSet (char driveId, FILEIO_FAT_MIRRORING mode);
+
+/***************************************************************************
+  Function:
+    int FILEIO_Sync (char driveId)
+
+    Summary:
+        Writes all cached changes on a drive to the media.
+
+    Description:
+        Writes the cached data and FAT sectors and the FAT32 free cluster 
+        information of a drive to the media, and copies any FAT sectors 
+        changed in FILEIO_FAT_MIRRORING_DEFERRED mode to the secondary 
+        copies of the FAT.  The directory entries of open files are not 
+        updated; use FILEIO_Flush for that.
+
+    Precondition:
+        The drive must be mounted.
+
+    Parameters:
+        driveId - Character representation of the mounted device.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_WRITE - Cached information could not be written to 
+          the media.
+  *****************************************************************************/
+int FILEIO_Sync (char driveId);
+
 /***************************************************************************
   Function:
     long FILEIO_Tell (FILEIO_OBJECT * handle)
@@ -1329,6 +1814,86 @@ int FILEIO_Find (const char * fileName, unsigned int attr, FILEIO_SEARCH_RECORD
   ***************************************************************************************************/
 int FILEIO_LongFileNameGet (FILEIO_SEARCH_RECORD * record, uint16_t * buffer, uint16_t length);
 
+/***************************************************************************
+  Function:
+    int FILEIO_DirectoryOpen (FILEIO_DIRECTORY_OBJECT * handle, const char * path)
+
+    Summary:
+        Opens a directory so its entries can be read with
+        FILEIO_DirectoryRead.
+
+    Description:
+        Opens a directory so its entries can be read with
+        FILEIO_DirectoryRead.  The handle is positioned at the first entry
+        of the directory.  No resources are held by an open directory
+        handle, so there is no corresponding close function; opening the
+        directory again will restart the read from the first entry.
+
+    Precondition:
+        A drive must have been mounted by the FILEIO library.
+
+    Parameters:
+        handle - The directory handle to initialize.
+        path - The path of the directory to open.  Use "." to open the
+            current working directory.
+
+    Returns:
+      * If Success: FILEIO_RESULT_SUCCESS
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_INVALID_ARGUMENT - The path could not be
+          resolved.
+        * FILEIO_ERROR_DIR_NOT_FOUND - The directory could not be found.
+  ***************************************************************************/
+int FILEIO_DirectoryOpen (FILEIO_DIRECTORY_OBJECT * handle, const char * path);
+
+/***************************************************************************
+  Function:
+    int FILEIO_DirectoryRead (FILEIO_DIRECTORY_OBJECT * handle, 
+        FILEIO_DIRECTORY_RECORD * records, uint16_t count, unsigned int attr)
+
+    Summary:
+        Reads a batch of entries from a directory opened with
+        FILEIO_DirectoryOpen.
+
+    Description:
+        Reads up to 'count' entries from a directory opened with
+        FILEIO_DirectoryOpen and copies their information into the
+        'records' array.  The directory is read in one forward pass and 
+        each call resumes after the last entry returned by the previous 
+        call.  Volume labels, deleted entries and long file name entries 
+        are skipped.  Entries are returned in the order they appear in the
+        directory, including the "." and ".." entries of subdirectories if 
+        the attr parameter allows directories.
+
+    Precondition:
+        The handle must have been initialized with FILEIO_DirectoryOpen and
+        the drive containing the directory must still be mounted.
+
+    Parameters:
+        handle - The directory handle.
+        records - An array of at least 'count' records to receive the 
+            entry information.
+        count - The maximum number of records to return.
+        attr - Inclusive OR of all of the attributes (FILEIO_ATTRIBUTES
+            structure members) that a returned entry may have.
+
+    Returns:
+      * If Success: The number of records returned.  A value less than
+        'count' indicates that the end of the directory was reached.
+      * If Failure: FILEIO_RESULT_FAILURE
+    
+      * Sets error code which can be retrieved with FILEIO_ErrorGet
+        * FILEIO_ERROR_INVALID_ARGUMENT - The drive containing the 
+          directory is no longer mounted.
+        * FILEIO_ERROR_WRITE - Cached data could not be written to the
+          device.
+        * FILEIO_ERROR_BAD_SECTOR_READ - A directory entry could not
+          be cached because there was an error reading from the device.                             
+  ***************************************************************************/
+int FILEIO_DirectoryRead (FILEIO_DIRECTORY_OBJECT * handle, FILEIO_DIRECTORY_RECORD * records, uint16_t count, unsigned int attr);
+
 /********************************************************************
   Function:
       FILEIO_FILE_SYSTEM_TYPE FILEIO_FileSystemTypeGet (char driveId)
@@ -1413,6 +1978,11 @@ FILEIO_FILE_SYSTEM_TYPE FILEIO_FileSystemTypeGet (char driveId);
     verified.  To continue a search, pass a pointer to the same FILEIO_FILEIO_DRIVE_PROPERTIES
     object that was passed in to create the search.
 
+    The free cluster count is remembered once the FAT has been searched, and is
+    kept current as clusters are allocated and freed.  On FAT32 volumes it is
+    also loaded from (and written back to) the FSInfo sector.  When the count
+    is known, the first call returns the complete results.
+
     A new search request should be made once this function has returned a value 
     other than FILEIO_GET_PROPERTIES_STILL_WORKING.  Continuing a completed search
     can result in undefined behavior or results.
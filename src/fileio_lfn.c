@@ -41,29 +41,74 @@ uint16_t lfnBuffer[256];
 
 #if defined (__XC16__) || defined (__XC32__)
     #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-        uint8_t __attribute__ ((aligned(4)))   gDataBuffer[FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global data sector buffer
-        uint8_t __attribute__ ((aligned(4)))   gFATBuffer[FILEIO_CONFIG_MEDIA_SECTOR_SIZE];       // The global FAT sector buffer
+        uint8_t __attribute__ ((aligned(4)))   gDataBuffer[FILEIO_CONFIG_DATA_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global data sector cache
+        uint8_t __attribute__ ((aligned(4)))   gFATBuffer[FILEIO_CONFIG_FAT_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];       // The global FAT sector cache
         FILEIO_BUFFER_STATUS bufferStatus;                                          // Status of the buffer contents (and buffer ownership)
     #else
-        uint8_t __attribute__ ((aligned(4)))   gDataBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];     // The global data sector buffer
-        uint8_t __attribute__ ((aligned(4)))   gFATBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global FAT sector buffer
+        uint8_t __attribute__ ((aligned(4)))   gDataBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_DATA_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];     // The global data sector cache
+        uint8_t __attribute__ ((aligned(4)))   gFATBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_FAT_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global FAT sector cache
         FILEIO_BUFFER_STATUS bufferStatus[FILEIO_CONFIG_MAX_DRIVES];
     #endif
 #else
     #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-        uint8_t gDataBuffer[FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global data sector buffer
-        uint8_t gFATBuffer[FILEIO_CONFIG_MEDIA_SECTOR_SIZE];       // The global FAT sector buffer
+        uint8_t gDataBuffer[FILEIO_CONFIG_DATA_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global data sector cache
+        uint8_t gFATBuffer[FILEIO_CONFIG_FAT_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];       // The global FAT sector cache
         FILEIO_BUFFER_STATUS bufferStatus;                                          // Status of the buffer contents (and buffer ownership)
     #else
-        uint8_t gDataBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];     // The global data sector buffer
-        uint8_t gFATBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global FAT sector buffer
+        uint8_t gDataBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_DATA_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];     // The global data sector cache
+        uint8_t gFATBuffer[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_FAT_CACHE_SECTORS][FILEIO_CONFIG_MEDIA_SECTOR_SIZE];      // The global FAT sector cache
         FILEIO_BUFFER_STATUS bufferStatus[FILEIO_CONFIG_MAX_DRIVES];
     #endif
 #endif
 
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+uint32_t gClusterBitmap[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CLUSTER_BITMAP_WORDS];        // Cluster allocation bitmap for each drive
+#endif
+
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+FILEIO_FREE_EXTENT gFreeExtents[FILEIO_CONFIG_MAX_DRIVES][FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE];      // Free extent index for each drive
+#endif
+
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+struct
+{
+    FILEIO_DIRECTORY_INDEX_RECORD records[FILEIO_DIRECTORY_INDEX_DIRECTORIES];     // The directories described by the index
+    FILEIO_DIRECTORY_INDEX_SLOT slots[FILEIO_CONFIG_DIRECTORY_INDEX_SIZE];          // Hashed names, probed linearly
+    uint32_t useCount;                                                              // Incremented each time an indexed directory is searched
+} gDirectoryIndex;
+#endif
+
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+struct
+{
+    FILEIO_PATH_CACHE_ENTRY entries[FILEIO_CONFIG_PATH_CACHE_SIZE];                 // Directories found by name
+    uint32_t useCount;                                                              // Incremented each time an entry is used
+} gPathCache;
+#endif
+
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+struct
+{
+    FILEIO_FREE_ENTRY_HINT hints[FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE];                // Free entries of recently used directories
+    uint32_t useCount;                                                              // Incremented each time a hint is used
+} gFreeEntryHints;
+#endif
+
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+struct
+{
+    FILEIO_DIRECTORY_CHAIN_MAP maps[FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES];        // Cluster chains of recently read directories
+    uint32_t useCount;                                                              // Incremented each time a map is used
+} gDirectoryChainMaps;
+#endif
+
 struct
 {
     FILEIO_DIRECTORY currentWorkingDirectory;
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    uint16_t workingDirectoryPath[FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE];     // Path of the current working directory, not null terminated
+    uint16_t workingDirectoryPathLength;                                        // Number of characters in the path, or 0 if it isn't known
+#endif
 } globalParameters;
 
 /************************************************************************************/
@@ -79,35 +124,55 @@ int FILEIO_Initialize (void)
 {
     int i;
 
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    memset (&gDirectoryIndex, 0, sizeof (gDirectoryIndex));
+#endif
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    memset (&gPathCache, 0, sizeof (gPathCache));
+#endif
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    memset (&gFreeEntryHints, 0, sizeof (gFreeEntryHints));
+#endif
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    memset (&gDirectoryChainMaps, 0, sizeof (gDirectoryChainMaps));
+#endif
+
     for (i = 0; i < FILEIO_CONFIG_MAX_DRIVES; i++)
     {
         gDriveSlotOpen[i] = true;
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+        gDriveArray[i].clusterBitmap = gClusterBitmap[i];
+        gDriveArray[i].clusterBitmapValid = false;
+#endif
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+        gDriveArray[i].freeExtents = gFreeExtents[i];
+        gDriveArray[i].freeExtentsValid = false;
+#endif
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-        gDriveArray[i].dataBuffer = &gDataBuffer[0];
-        gDriveArray[i].fatBuffer = &gFATBuffer[0];
+        gDriveArray[i].dataBuffer = &gDataBuffer[0][0];
+        gDriveArray[i].fatBuffer = &gFATBuffer[0][0];
         gDriveArray[i].bufferStatusPtr = &bufferStatus;
 #else
-        gDriveArray[i].dataBuffer = &gDataBuffer[i][0];
-        gDriveArray[i].fatBuffer = &gFATBuffer[i][0];
+        gDriveArray[i].dataBuffer = &gDataBuffer[i][0][0];
+        gDriveArray[i].fatBuffer = &gFATBuffer[i][0][0];
         gDriveArray[i].bufferStatusPtr = &bufferStatus[i];
-        bufferStatus[i].flags.dataBufferNeedsWrite = false;
-        bufferStatus[i].flags.fatBufferNeedsWrite = false;
-        bufferStatus[i].dataBufferCachedSector = 0xFFFFFFFF;
-        bufferStatus[i].fatBufferCachedSector = 0xFFFFFFFF;
+        FILEIO_DataCacheInitialize (&bufferStatus[i], &gDataBuffer[i][0][0]);
+        FILEIO_FATCacheInvalidate (&bufferStatus[i]);
 #endif
     }
 
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
     bufferStatus.driveOwner = NULL;
-    bufferStatus.flags.dataBufferNeedsWrite = false;
-    bufferStatus.flags.fatBufferNeedsWrite = false;
-    bufferStatus.dataBufferCachedSector = 0xFFFFFFFF;
-    bufferStatus.fatBufferCachedSector = 0xFFFFFFFF;
+    FILEIO_DataCacheInitialize (&bufferStatus, &gDataBuffer[0][0]);
+    FILEIO_FATCacheInvalidate (&bufferStatus);
 #endif
     
     globalParameters.currentWorkingDirectory.drive = 0;
     globalParameters.currentWorkingDirectory.cluster = 0;
     globalParameters.currentWorkingDirectory.currentEntry = 0;
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    globalParameters.workingDirectoryPathLength = 0;
+#endif
 
     return true;
 }
@@ -179,6 +244,32 @@ FILEIO_ERROR_TYPE FILEIO_DriveMount (uint16_t driveId, const FILEIO_DRIVE_CONFIG
         return FILEIO_ERROR_TOO_MANY_DRIVES_OPEN;
     }
 
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    // The allocation bitmap will be loaded from the FAT the first time a cluster is allocated
+    drive->clusterBitmapValid = false;
+    drive->clusterBitmapBase = 2;
+#endif
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    drive->freeExtentsValid = false;
+#endif
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    FILEIO_DirectoryIndexDriveDrop (drive);
+#endif
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    FILEIO_PathCacheDriveDrop (drive);
+#endif
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    FILEIO_FreeEntryHintDriveDrop (drive);
+#endif
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    FILEIO_DirectoryChainMapDriveDrop (drive);
+#endif
+    drive->allocationPolicy = FILEIO_ALLOCATION_NEXT_FIT;
+    drive->fatMirroring = FILEIO_FAT_MIRRORING_IMMEDIATE;
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    drive->fatMirrorRangeCount = 0;
+#endif
+
     // Reinitialize the drive cache information
     // This will force the library to recache sectors if a drive is unmounted and re-mounted
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
@@ -187,10 +278,8 @@ FILEIO_ERROR_TYPE FILEIO_DriveMount (uint16_t driveId, const FILEIO_DRIVE_CONFIG
         drive->bufferStatusPtr->driveOwner = NULL;
     }
 #else
-    bufferStatus[i].flags.dataBufferNeedsWrite = false;
-    bufferStatus[i].flags.fatBufferNeedsWrite = false;
-    bufferStatus[i].dataBufferCachedSector = 0xFFFFFFFF;
-    bufferStatus[i].fatBufferCachedSector = 0xFFFFFFFF;
+    FILEIO_DataCacheInvalidate (drive->bufferStatusPtr);
+    FILEIO_FATCacheInvalidate (drive->bufferStatusPtr);
 #endif
 
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
@@ -230,7 +319,11 @@ FILEIO_ERROR_TYPE FILEIO_DriveMount (uint16_t driveId, const FILEIO_DRIVE_CONFIG
         if ((error = FILEIO_LoadMBR (drive)) == FILEIO_ERROR_NONE)
         {
             // Load the boot sector
-            error = FILEIO_LoadBootSector(drive);
+            if ((error = FILEIO_LoadBootSector(drive)) == FILEIO_ERROR_NONE)
+            {
+                // Load the free cluster count and next free cluster hint
+                FILEIO_FSInfoLoad (drive);
+            }
         }
     }
 
@@ -242,6 +335,11 @@ FILEIO_ERROR_TYPE FILEIO_DriveMount (uint16_t driveId, const FILEIO_DRIVE_CONFIG
             globalParameters.currentWorkingDirectory.drive = drive;
             globalParameters.currentWorkingDirectory.cluster = drive->firstRootCluster;
             globalParameters.currentWorkingDirectory.currentEntry = 0;
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+            globalParameters.workingDirectoryPath[0] = drive->driveId;
+            globalParameters.workingDirectoryPath[1] = ':';
+            globalParameters.workingDirectoryPathLength = 2;
+#endif
         }
     }
     else
@@ -517,14 +615,27 @@ FILEIO_ERROR_TYPE FILEIO_LoadBootSector (FILEIO_DRIVE * drive)
                     {
                         #ifdef __XC8__
                             drive->firstRootCluster = ptrBootSector->biosParameterBlock.fat32.firstClusterRootDirectory;
+                            drive->fsInfoSector = ptrBootSector->biosParameterBlock.fat32.fileSystemInformation;
                         #else
                             memcpy(&drive->firstRootCluster, &drive->dataBuffer[BSI_ROOTCLUS], 4 );
+                            drive->fsInfoSector = 0;
+                            memcpy(&drive->fsInfoSector, &drive->dataBuffer[BSI_FSINFO], 2);
                         #endif
+                        // An FSInfo sector number of 0 or 0xFFFF means the volume doesn't have one
+                        if ((drive->fsInfoSector != 0) && (drive->fsInfoSector != 0xFFFF))
+                        {
+                            drive->fsInfoSector += drive->firstPartitionSector;
+                        }
+                        else
+                        {
+                            drive->fsInfoSector = 0;
+                        }
                         drive->firstDataSector = drive->firstRootSector + rootDirectorySectors;
                     }
                     else
                     {
                         drive->firstRootCluster = 0;
+                        drive->fsInfoSector = 0;
                         drive->firstDataSector = drive->firstRootSector + (drive->rootDirectoryEntryCount >> 4);
                     }
 
@@ -599,6 +710,133 @@ FILEIO_ERROR_TYPE FILEIO_LoadBootSector (FILEIO_DRIVE * drive)
     return error;
 }
 
+void FILEIO_FSInfoLoad (FILEIO_DRIVE * drive)
+{
+    uint8_t * fatSector;
+    uint32_t value;
+
+    drive->freeClusterCount = FILEIO_FREE_CLUSTER_COUNT_UNKNOWN;
+    drive->fsInfoNeedsWrite = false;
+    drive->volumeState = FILEIO_VOLUME_STATE_UNTRACKED;
+
+    if (drive->type != FILEIO_FILE_SYSTEM_TYPE_FAT32)
+    {
+        return;
+    }
+
+    // The free cluster count can only be trusted if the volume was unmounted cleanly
+    if ((fatSector = FILEIO_FATCacheSectorGet (drive, drive->firstFatSector, false)) == NULL)
+    {
+        return;
+    }
+
+    if ((*(fatSector + 7) & FILEIO_FAT32_CLEAN_SHUTDOWN_MASK) != 0)
+    {
+        drive->volumeState = FILEIO_VOLUME_STATE_CLEAN;
+    }
+
+    if ((drive->fsInfoSector == 0) || (FILEIO_DataCacheSectorGet (drive, drive->fsInfoSector, true) != FILEIO_ERROR_NONE))
+    {
+        return;
+    }
+
+    memcpy (&value, &drive->dataBuffer[FSI_LEADSIG], 4);
+    if (value != FILEIO_FSINFO_LEAD_SIGNATURE)
+    {
+        return;
+    }
+    memcpy (&value, &drive->dataBuffer[FSI_STRUCSIG], 4);
+    if (value != FILEIO_FSINFO_STRUCT_SIGNATURE)
+    {
+        return;
+    }
+    memcpy (&value, &drive->dataBuffer[FSI_TRAILSIG], 4);
+    if (value != FILEIO_FSINFO_TRAIL_SIGNATURE)
+    {
+        return;
+    }
+
+    // Start searching for free clusters at the hint
+    memcpy (&value, &drive->dataBuffer[FSI_NXT_FREE], 4);
+    if ((value >= 2) && (value < (drive->partitionClusterCount + 2)))
+    {
+        drive->currentCluster = value;
+    }
+
+    memcpy (&value, &drive->dataBuffer[FSI_FREE_COUNT], 4);
+    if ((drive->volumeState == FILEIO_VOLUME_STATE_CLEAN) && (value <= drive->partitionClusterCount))
+    {
+        drive->freeClusterCount = value;
+    }
+}
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+bool FILEIO_FSInfoWrite (FILEIO_DRIVE * drive)
+{
+    uint32_t value;
+
+    if (!drive->fsInfoNeedsWrite || (drive->fsInfoSector == 0))
+    {
+        return true;
+    }
+
+    if (FILEIO_DataCacheSectorGet (drive, drive->fsInfoSector, true) != FILEIO_ERROR_NONE)
+    {
+        return false;
+    }
+
+    // Rebuild the sector if it isn't a valid FSInfo sector
+    memcpy (&value, &drive->dataBuffer[FSI_LEADSIG], 4);
+    if (value != FILEIO_FSINFO_LEAD_SIGNATURE)
+    {
+        memset (drive->dataBuffer, 0x00, drive->sectorSize);
+        value = FILEIO_FSINFO_LEAD_SIGNATURE;
+        memcpy (&drive->dataBuffer[FSI_LEADSIG], &value, 4);
+        value = FILEIO_FSINFO_STRUCT_SIGNATURE;
+        memcpy (&drive->dataBuffer[FSI_STRUCSIG], &value, 4);
+        value = FILEIO_FSINFO_TRAIL_SIGNATURE;
+        memcpy (&drive->dataBuffer[FSI_TRAILSIG], &value, 4);
+    }
+
+    memcpy (&drive->dataBuffer[FSI_FREE_COUNT], &drive->freeClusterCount, 4);
+    memcpy (&drive->dataBuffer[FSI_NXT_FREE], &drive->currentCluster, 4);
+    drive->bufferStatusPtr->flags.dataBufferNeedsWrite = true;
+
+    if (!FILEIO_FlushBuffer (drive, FILEIO_BUFFER_DATA))
+    {
+        return false;
+    }
+
+    drive->fsInfoNeedsWrite = false;
+
+    return true;
+}
+
+bool FILEIO_VolumeStateSet (FILEIO_DRIVE * drive, FILEIO_VOLUME_STATE state)
+{
+    uint8_t * fatSector;
+
+    if ((fatSector = FILEIO_FATCacheSectorGet (drive, drive->firstFatSector, true)) == NULL)
+    {
+        return false;
+    }
+
+    if (state == FILEIO_VOLUME_STATE_CLEAN)
+    {
+        *(fatSector + 7) |= FILEIO_FAT32_CLEAN_SHUTDOWN_MASK;
+    }
+    else
+    {
+        *(fatSector + 7) &= ~FILEIO_FAT32_CLEAN_SHUTDOWN_MASK;
+    }
+
+    drive->volumeState = state;
+
+    // Make sure the media shows the volume in use before any other FAT sector is changed
+    return FILEIO_FlushBuffer (drive, FILEIO_BUFFER_FAT);
+}
+#endif
+
 int FILEIO_DriveUnmount (const uint16_t driveId)
 {
     FILEIO_DRIVE * drive;
@@ -612,6 +850,24 @@ int FILEIO_DriveUnmount (const uint16_t driveId)
     }
     else
     {
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+        // Record the free cluster count, update the secondary FAT copies and mark the volume as cleanly unmounted
+        if (drive->fsInfoNeedsWrite || (drive->volumeState == FILEIO_VOLUME_STATE_IN_USE) || (drive->fatMirroring == FILEIO_FAT_MIRRORING_DEFERRED))
+        {
+    #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+            if (FILEIO_GetSingleBuffer (drive) == FILEIO_RESULT_SUCCESS)
+    #endif
+            {
+                if (FILEIO_FSInfoWrite (drive) && FILEIO_FlushBuffer (drive, FILEIO_BUFFER_FAT) && FILEIO_FATMirrorSync (drive) && (drive->volumeState == FILEIO_VOLUME_STATE_IN_USE))
+                {
+                    if (FILEIO_VolumeStateSet (drive, FILEIO_VOLUME_STATE_CLEAN))
+                    {
+                        FILEIO_FATMirrorSync (drive);
+                    }
+                }
+            }
+        }
+#endif
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
     #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
         if (drive->bufferStatusPtr->driveOwner == drive)
@@ -631,6 +887,13 @@ int FILEIO_DriveUnmount (const uint16_t driveId)
 
     drive->driveConfig->funcMediaDeinit(drive->mediaParameters);
 
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    FILEIO_PathCacheDriveDrop (drive);
+#endif
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    FILEIO_DirectoryChainMapDriveDrop (drive);
+#endif
+
     for (i = 0; i < FILEIO_CONFIG_MAX_DRIVES; i++)
     {
         if (gDriveArray[i].driveId == driveId)
@@ -648,6 +911,9 @@ int FILEIO_DriveUnmount (const uint16_t driveId)
         globalParameters.currentWorkingDirectory.cluster = 0;
         globalParameters.currentWorkingDirectory.drive = NULL;
         globalParameters.currentWorkingDirectory.currentEntry = 0;
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+        globalParameters.workingDirectoryPathLength = 0;
+#endif
     }
 
     return FILEIO_RESULT_SUCCESS;
@@ -816,15 +1082,22 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const uint16_t * fileName, uint16_t mo
     
     currentCluster = directory.cluster;
 
+    // Rewriting a file that can't be written would only discard its contents
+    if ((mode & (FILEIO_OPEN_REWRITE | FILEIO_OPEN_WRITE)) == FILEIO_OPEN_REWRITE)
+    {
+        directory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
 #if defined (FILEIO_CONFIG_WRITE_DISABLE)
-    if (mode & (FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE))
+    if (mode & (FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE | FILEIO_OPEN_REWRITE))
     {
         directory.drive->error = FILEIO_ERROR_WRITE_PROTECTED;
         return FILEIO_RESULT_FAILURE;
     }
 #endif
 
-    if((*directory.drive->driveConfig->funcWriteProtectGet)(directory.drive->mediaParameters) && ((mode & (FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE)) != 0))
+    if((*directory.drive->driveConfig->funcWriteProtectGet)(directory.drive->mediaParameters) && ((mode & (FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE | FILEIO_OPEN_REWRITE)) != 0))
     {
         directory.drive->error = FILEIO_ERROR_WRITE_PROTECTED;
         return FILEIO_RESULT_FAILURE;
@@ -837,6 +1110,10 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const uint16_t * fileName, uint16_t mo
         return FILEIO_RESULT_FAILURE;
     }
 
+    FILEIO_ExtentMapSet (filePtr, NULL, 0);
+    filePtr->windowStart = 0;
+    filePtr->windowEnd = 0;
+
     fileNameType = FILEIO_FileNameTypeGet(fileName, false);
 
     if (fileNameType == FILEIO_NAME_SHORT)
@@ -879,6 +1156,12 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const uint16_t * fileName, uint16_t mo
         {
             // Use the CREATE flag to indicate whether the file should be created
             mode &= ~FILEIO_OPEN_CREATE;
+
+            if ((mode & FILEIO_OPEN_REWRITE) == FILEIO_OPEN_REWRITE)
+            {
+                // Overwrite the file through its existing chain; the part of it that isn't reused is freed on close
+                filePtr->size = 0;
+            }
         }
     }
     else
@@ -928,6 +1211,8 @@ int FILEIO_Open (FILEIO_OBJECT * filePtr, const uint16_t * fileName, uint16_t mo
         {
             filePtr->flags.writeEnabled = false;
         }
+
+        filePtr->flags.truncateOnClose = ((mode & (FILEIO_OPEN_REWRITE | FILEIO_OPEN_CREATE)) == FILEIO_OPEN_REWRITE);
 #endif
 
         if ((mode & FILEIO_OPEN_APPEND) == FILEIO_OPEN_APPEND)
@@ -1140,6 +1425,106 @@ uint16_t FILEIO_FindNextDelimiter(const uint16_t * path)
 }
 #endif
 
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+// Changes directory to the directory named by the first component of path, if the path cache has it
+bool FILEIO_PathCacheFind (FILEIO_DIRECTORY * directory, const uint16_t * path)
+{
+    FILEIO_PATH_CACHE_ENTRY * entry;
+    uint32_t parent = directory->cluster;
+    uint8_t i, j;
+
+    if (parent == 0)
+    {
+        parent = directory->drive->firstRootCluster;
+    }
+
+    for (i = 0, entry = gPathCache.entries; i < FILEIO_CONFIG_PATH_CACHE_SIZE; i++, entry++)
+    {
+        if ((entry->drive != directory->drive) || (entry->parent != parent))
+        {
+            continue;
+        }
+
+        for (j = 0; (entry->name[j] != 0) && (entry->name[j] == path[j]); j++);
+
+        if ((entry->name[j] == 0) && ((path[j] == 0) || (path[j] == FILEIO_CONFIG_DELIMITER)))
+        {
+            entry->lastUse = ++gPathCache.useCount;
+            directory->cluster = entry->cluster;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Remembers the directory named by the first component of path
+void FILEIO_PathCacheAdd (FILEIO_DIRECTORY * directory, const uint16_t * path, uint32_t cluster)
+{
+    FILEIO_PATH_CACHE_ENTRY * entry = gPathCache.entries;
+    uint8_t i;
+
+    for (i = 0; (path[i] != 0) && (path[i] != FILEIO_CONFIG_DELIMITER); i++)
+    {
+        if (i == FILEIO_PATH_CACHE_NAME_LENGTH - 1)
+        {
+            return;
+        }
+    }
+
+    // Use a free entry, or replace the one that was used least recently
+    for (i = 0; i < FILEIO_CONFIG_PATH_CACHE_SIZE; i++)
+    {
+        if (gPathCache.entries[i].drive == NULL)
+        {
+            entry = gPathCache.entries + i;
+            break;
+        }
+        if (gPathCache.entries[i].lastUse < entry->lastUse)
+        {
+            entry = gPathCache.entries + i;
+        }
+    }
+
+    entry->drive = directory->drive;
+    entry->parent = (directory->cluster == 0) ? directory->drive->firstRootCluster : directory->cluster;
+    entry->cluster = cluster;
+    entry->lastUse = ++gPathCache.useCount;
+    for (i = 0; (path[i] != 0) && (path[i] != FILEIO_CONFIG_DELIMITER); i++)
+    {
+        entry->name[i] = path[i];
+    }
+    entry->name[i] = 0;
+}
+
+// Forgets a directory that was renamed or removed, and the directories in it
+void FILEIO_PathCacheDrop (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_PATH_CACHE_SIZE; i++)
+    {
+        if ((gPathCache.entries[i].drive == drive) && ((gPathCache.entries[i].cluster == cluster) || (gPathCache.entries[i].parent == cluster)))
+        {
+            gPathCache.entries[i].drive = NULL;
+        }
+    }
+}
+
+void FILEIO_PathCacheDriveDrop (FILEIO_DRIVE * drive)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_PATH_CACHE_SIZE; i++)
+    {
+        if (gPathCache.entries[i].drive == drive)
+        {
+            gPathCache.entries[i].drive = NULL;
+        }
+    }
+}
+#endif
+
 #if !defined (FILEIO_CONFIG_DIRECTORY_DISABLE)
 FILEIO_RESULT FILEIO_DirectoryChangeSingle (FILEIO_DIRECTORY * directory, uint16_t * path)
 {
@@ -1150,6 +1535,13 @@ FILEIO_RESULT FILEIO_DirectoryChangeSingle (FILEIO_DIRECTORY * directory, uint16
     FILEIO_OBJECT file;
     FILEIO_OBJECT * filePtr = &file;
 
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    if (FILEIO_PathCacheFind (directory, path))
+    {
+        return FILEIO_RESULT_SUCCESS;
+    }
+#endif
+
     fileNameType = FILEIO_FileNameTypeGet(path, false);
 
     if (fileNameType == FILEIO_NAME_INVALID)
@@ -1209,6 +1601,12 @@ FILEIO_RESULT FILEIO_DirectoryChangeSingle (FILEIO_DIRECTORY * directory, uint16
     if (error == FILEIO_ERROR_NONE)
     {
         // Directory found
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+        if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+        {
+            FILEIO_PathCacheAdd (directory, path, filePtr->firstCluster);
+        }
+#endif
         directory->cluster = filePtr->firstCluster;
     }
     else
@@ -1316,7 +1714,12 @@ FILEIO_RESULT FILEIO_DirectoryMakeSingle (FILEIO_DIRECTORY * directory, uint16_t
 int FILEIO_DotEntryWrite (FILEIO_DRIVE * drive, uint32_t dot, uint32_t dotdot, FILEIO_TIMESTAMP * timeStamp)
 {
     FILEIO_DIRECTORY_ENTRY * entryPtr;
-    uint32_t sector;
+    uint32_t sector = FILEIO_ClusterToSector (drive, dot);
+
+    if (FILEIO_DataCacheSectorGet (drive, sector, false) != FILEIO_ERROR_NONE)
+    {
+        return false;
+    }
 
 	memset(drive->dataBuffer, 0x00, drive->sectorSize);
 
@@ -1347,10 +1750,7 @@ int FILEIO_DotEntryWrite (FILEIO_DRIVE * drive, uint32_t dot, uint32_t dotdot, F
     entryPtr->firstClusterLow = (uint16_t)(dotdot & 0x0000FFFF); // Lower 16 bit address
     entryPtr->firstClusterHigh = (uint16_t)((dotdot & 0x0FFF0000)>> 16); // Higher 16 bit address. FAT32 uses only 28 bits. Mask even higher nibble also.
 
-    sector = FILEIO_ClusterToSector (drive, dot);
-
     drive->bufferStatusPtr->flags.dataBufferNeedsWrite = true;
-    drive->bufferStatusPtr->dataBufferCachedSector = sector;
 
     if (!FILEIO_FlushBuffer (drive, FILEIO_BUFFER_DATA))
     {
@@ -1362,40 +1762,333 @@ int FILEIO_DotEntryWrite (FILEIO_DRIVE * drive, uint32_t dot, uint32_t dotdot, F
 #endif
 #endif
 
-FILEIO_ERROR_TYPE FILEIO_FindShortFileName (FILEIO_DIRECTORY * directory, FILEIO_OBJECT * filePtr, uint8_t * fileName, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset, uint16_t attributes, FILEIO_SEARCH_TYPE mode)
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+// Hashes a short name as it is stored in a directory entry, or, if shortName is NULL, a long name ending with a null
+// or a delimiter
+uint16_t FILEIO_DirectoryIndexHash (const uint8_t * shortName, const uint16_t * longName)
 {
-    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
-    FILEIO_DIRECTORY_ENTRY * entry;
+    uint32_t hash = 2166136261UL;
+    uint16_t c;
+    uint8_t i;
 
-    if (*currentCluster == 0)
+    if (shortName != NULL)
     {
-        *currentCluster = directory->drive->firstRootCluster;
+        for (i = 0; i < FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX; i++)
+        {
+            hash = (hash ^ shortName[i]) * 16777619UL;
+        }
     }
-
-    while(1)
+    else
     {
-        do
+        while (((c = *longName++) != 0) && (c != FILEIO_CONFIG_DELIMITER))
         {
-            entry = FILEIO_DirectoryEntryCache (directory, &error, currentCluster, currentClusterOffset, entryOffset);
-            if (error == FILEIO_ERROR_DONE)
-            {
-                break;
-            }
-            else if (error == FILEIO_ERROR_BAD_CACHE_READ)
-            {
-                directory->drive->error = FILEIO_ERROR_BAD_CACHE_READ;
-                return error;
-            }
+            hash = (hash ^ c) * 16777619UL;
+        }
+    }
 
-            if(entry->attributes == FILEIO_ATTRIBUTE_VOLUME && (attributes == FILEIO_ATTRIBUTE_VOLUME))
-            {
-                break;
-            }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
 
-            entryOffset++;
-        } while (((entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME) || (entry->attributes == FILEIO_ATTRIBUTE_VOLUME) || (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED)) && (entry->name[0] != FILEIO_DIRECTORY_ENTRY_EMPTY));
+uint8_t FILEIO_DirectoryIndexRecordFind (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    uint8_t i;
 
-        if ((error == FILEIO_ERROR_DONE) || (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY))
+    if (cluster == 0)
+    {
+        cluster = drive->firstRootCluster;
+    }
+
+    for (i = 0; i < FILEIO_DIRECTORY_INDEX_DIRECTORIES; i++)
+    {
+        if ((gDirectoryIndex.records[i].state != FILEIO_DIRECTORY_INDEX_UNUSED) && (gDirectoryIndex.records[i].drive == drive) && (gDirectoryIndex.records[i].cluster == cluster))
+        {
+            return i;
+        }
+    }
+
+    return FILEIO_DIRECTORY_INDEX_NONE;
+}
+
+// Returns the index record of a directory, indexing the directory first if it isn't indexed yet.  Returns
+// FILEIO_DIRECTORY_INDEX_NONE if the directory must be searched directly.
+uint8_t FILEIO_DirectoryIndexGet (FILEIO_DIRECTORY * directory)
+{
+    FILEIO_DIRECTORY_INDEX_RECORD * record;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint32_t cluster = directory->cluster;
+    uint32_t currentCluster;
+    uint16_t currentClusterOffset = 0;
+    uint16_t entryOffset;
+    uint8_t number, checksum, i;
+    uint8_t * source;
+
+    if (cluster == 0)
+    {
+        cluster = directory->drive->firstRootCluster;
+    }
+
+    if ((number = FILEIO_DirectoryIndexRecordFind (directory->drive, cluster)) != FILEIO_DIRECTORY_INDEX_NONE)
+    {
+        gDirectoryIndex.records[number].lastUse = ++gDirectoryIndex.useCount;
+        return (gDirectoryIndex.records[number].state == FILEIO_DIRECTORY_INDEX_VALID) ? number : FILEIO_DIRECTORY_INDEX_NONE;
+    }
+
+    // Use a free record, or drop the directory that was searched least recently
+    for (i = 0, number = 0; i < FILEIO_DIRECTORY_INDEX_DIRECTORIES; i++)
+    {
+        if (gDirectoryIndex.records[i].state == FILEIO_DIRECTORY_INDEX_UNUSED)
+        {
+            number = i;
+            break;
+        }
+        if (gDirectoryIndex.records[i].lastUse < gDirectoryIndex.records[number].lastUse)
+        {
+            number = i;
+        }
+    }
+    FILEIO_DirectoryIndexRecordDrop (number);
+
+    record = gDirectoryIndex.records + number;
+    record->drive = directory->drive;
+    record->cluster = cluster;
+    record->lastUse = ++gDirectoryIndex.useCount;
+    record->state = FILEIO_DIRECTORY_INDEX_VALID;
+
+    // Add the short and long names of every file in the directory
+    currentCluster = cluster;
+    for (entryOffset = 0; ; entryOffset++)
+    {
+        entry = FILEIO_DirectoryEntryCache (directory, &error, &currentCluster, &currentClusterOffset, entryOffset);
+        if ((error == FILEIO_ERROR_DONE) || ((error == FILEIO_ERROR_NONE) && (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY)))
+        {
+            return number;
+        }
+        else if (error != FILEIO_ERROR_NONE)
+        {
+            FILEIO_DirectoryIndexRecordDrop (number);
+            return FILEIO_DIRECTORY_INDEX_NONE;
+        }
+
+        if ((entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME) || (entry->attributes == FILEIO_ATTRIBUTE_VOLUME) || (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED))
+        {
+            continue;
+        }
+
+        checksum = 0;
+        source = (uint8_t *)entry->name;
+        for (i = 11; i != 0; i--)
+        {
+            checksum = ((checksum & 1) ? 0x80 : 0) + (checksum >> 1) + *source++;
+        }
+
+        if (!FILEIO_DirectoryIndexInsert (number, FILEIO_DirectoryIndexHash ((uint8_t *)entry->name, NULL), entryOffset) ||
+            ((FILEIO_LongFileNameCache (directory, entryOffset, currentCluster, checksum) == FILEIO_LFN_SUCCESS) && !FILEIO_DirectoryIndexInsert (number, FILEIO_DirectoryIndexHash (NULL, lfnBuffer), entryOffset)))
+        {
+            // The directory doesn't fit.  Drop the names added for it and remember to search it directly; the other
+            // directories keep their names.
+            FILEIO_DirectoryIndexRecordDrop (number);
+            record->drive = directory->drive;
+            record->cluster = cluster;
+            record->lastUse = gDirectoryIndex.useCount;
+            record->state = FILEIO_DIRECTORY_INDEX_OVERFLOW;
+            return FILEIO_DIRECTORY_INDEX_NONE;
+        }
+    }
+}
+
+// Returns the directory entry offset of the next name slot of the directory with the given hash.  *position must be 0
+// for the first call.
+bool FILEIO_DirectoryIndexNext (uint8_t record, uint16_t hash, uint16_t * position, uint16_t * entry)
+{
+    FILEIO_DIRECTORY_INDEX_SLOT * slot;
+
+    while (*position < FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    {
+        slot = gDirectoryIndex.slots + (((uint32_t)hash + *position) % FILEIO_CONFIG_DIRECTORY_INDEX_SIZE);
+        (*position)++;
+
+        if (slot->directory == FILEIO_DIRECTORY_INDEX_SLOT_EMPTY)
+        {
+            break;
+        }
+        if ((slot->directory == record + 1) && (slot->hash == hash))
+        {
+            *entry = slot->entry;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FILEIO_DirectoryIndexInsert (uint8_t record, uint16_t hash, uint16_t entry)
+{
+    FILEIO_DIRECTORY_INDEX_SLOT * slot;
+    uint16_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_DIRECTORY_INDEX_SIZE; i++)
+    {
+        slot = gDirectoryIndex.slots + (((uint32_t)hash + i) % FILEIO_CONFIG_DIRECTORY_INDEX_SIZE);
+        if ((slot->directory == FILEIO_DIRECTORY_INDEX_SLOT_EMPTY) || (slot->directory == FILEIO_DIRECTORY_INDEX_SLOT_DELETED))
+        {
+            slot->hash = hash;
+            slot->entry = entry;
+            slot->directory = record + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Adds the names of a new directory entry to the index, if its directory is indexed
+void FILEIO_DirectoryIndexAdd (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry, const uint8_t * shortName, const uint16_t * longName)
+{
+    uint8_t number = FILEIO_DirectoryIndexRecordFind (drive, cluster);
+
+    if ((number == FILEIO_DIRECTORY_INDEX_NONE) || (gDirectoryIndex.records[number].state != FILEIO_DIRECTORY_INDEX_VALID))
+    {
+        return;
+    }
+
+    if (!FILEIO_DirectoryIndexInsert (number, FILEIO_DirectoryIndexHash (shortName, NULL), entry) ||
+        ((longName != NULL) && !FILEIO_DirectoryIndexInsert (number, FILEIO_DirectoryIndexHash (NULL, longName), entry)))
+    {
+        // The directory will be indexed again the next time it is searched
+        FILEIO_DirectoryIndexRecordDrop (number);
+    }
+}
+
+// Removes the names of a deleted directory entry from the index
+void FILEIO_DirectoryIndexRemove (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry)
+{
+    uint8_t number = FILEIO_DirectoryIndexRecordFind (drive, cluster);
+    uint16_t i;
+
+    if ((number == FILEIO_DIRECTORY_INDEX_NONE) || (gDirectoryIndex.records[number].state != FILEIO_DIRECTORY_INDEX_VALID))
+    {
+        return;
+    }
+
+    for (i = 0; i < FILEIO_CONFIG_DIRECTORY_INDEX_SIZE; i++)
+    {
+        if ((gDirectoryIndex.slots[i].directory == number + 1) && (gDirectoryIndex.slots[i].entry == entry))
+        {
+            gDirectoryIndex.slots[i].directory = FILEIO_DIRECTORY_INDEX_SLOT_DELETED;
+        }
+    }
+}
+
+void FILEIO_DirectoryIndexDrop (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    uint8_t number = FILEIO_DirectoryIndexRecordFind (drive, cluster);
+
+    if (number != FILEIO_DIRECTORY_INDEX_NONE)
+    {
+        FILEIO_DirectoryIndexRecordDrop (number);
+    }
+}
+
+void FILEIO_DirectoryIndexDriveDrop (FILEIO_DRIVE * drive)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_DIRECTORY_INDEX_DIRECTORIES; i++)
+    {
+        if (gDirectoryIndex.records[i].drive == drive)
+        {
+            FILEIO_DirectoryIndexRecordDrop (i);
+        }
+    }
+}
+
+void FILEIO_DirectoryIndexRecordDrop (uint8_t number)
+{
+    uint16_t i;
+    uint8_t inUse = 0;
+
+    gDirectoryIndex.records[number].state = FILEIO_DIRECTORY_INDEX_UNUSED;
+    gDirectoryIndex.records[number].drive = NULL;
+
+    for (i = 0; i < FILEIO_DIRECTORY_INDEX_DIRECTORIES; i++)
+    {
+        if (gDirectoryIndex.records[i].state == FILEIO_DIRECTORY_INDEX_VALID)
+        {
+            inUse++;
+        }
+    }
+
+    for (i = 0; i < FILEIO_CONFIG_DIRECTORY_INDEX_SIZE; i++)
+    {
+        if (inUse == 0)
+        {
+            // Nothing is indexed, so the deleted slots can be cleared too
+            gDirectoryIndex.slots[i].directory = FILEIO_DIRECTORY_INDEX_SLOT_EMPTY;
+        }
+        else if (gDirectoryIndex.slots[i].directory == number + 1)
+        {
+            gDirectoryIndex.slots[i].directory = FILEIO_DIRECTORY_INDEX_SLOT_DELETED;
+        }
+    }
+}
+#endif
+
+FILEIO_ERROR_TYPE FILEIO_FindShortFileName (FILEIO_DIRECTORY * directory, FILEIO_OBJECT * filePtr, uint8_t * fileName, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset, uint16_t attributes, FILEIO_SEARCH_TYPE mode)
+{
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    FILEIO_DIRECTORY_ENTRY * entry;
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    uint16_t hash, position = 0;
+    uint8_t record;
+#endif
+
+    if (*currentCluster == 0)
+    {
+        *currentCluster = directory->drive->firstRootCluster;
+    }
+
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    // Only check the entries the directory index gives for the name
+    if ((mode == FILEIO_SEARCH_ENTRY_MATCH) && (entryOffset == 0) && (attributes != FILEIO_ATTRIBUTE_VOLUME) && ((record = FILEIO_DirectoryIndexGet (directory)) != FILEIO_DIRECTORY_INDEX_NONE))
+    {
+        hash = FILEIO_DirectoryIndexHash (fileName, NULL);
+        while (FILEIO_DirectoryIndexNext (record, hash, &position, &entryOffset))
+        {
+            if ((error = FILEIO_FindShortFileName (directory, filePtr, fileName, currentCluster, currentClusterOffset, entryOffset, attributes, FILEIO_SEARCH_ENTRY_MATCH | FILEIO_SEARCH_SINGLE_ENTRY)) != FILEIO_ERROR_DONE)
+            {
+                return error;
+            }
+        }
+
+        return FILEIO_ERROR_DONE;
+    }
+#endif
+
+    while(1)
+    {
+        do
+        {
+            entry = FILEIO_DirectoryEntryCache (directory, &error, currentCluster, currentClusterOffset, entryOffset);
+            if (error == FILEIO_ERROR_DONE)
+            {
+                break;
+            }
+            else if (error == FILEIO_ERROR_BAD_CACHE_READ)
+            {
+                directory->drive->error = FILEIO_ERROR_BAD_CACHE_READ;
+                return error;
+            }
+
+            if(entry->attributes == FILEIO_ATTRIBUTE_VOLUME && (attributes == FILEIO_ATTRIBUTE_VOLUME))
+            {
+                break;
+            }
+
+            entryOffset++;
+        } while (((entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME) || (entry->attributes == FILEIO_ATTRIBUTE_VOLUME) || (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED)) && (entry->name[0] != FILEIO_DIRECTORY_ENTRY_EMPTY));
+
+        if ((error == FILEIO_ERROR_DONE) || (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY))
         {
             return FILEIO_ERROR_DONE;
         }
@@ -1435,6 +2128,11 @@ FILEIO_ERROR_TYPE FILEIO_FindShortFileName (FILEIO_DIRECTORY * directory, FILEIO
                 return FILEIO_ERROR_NONE;
             }
         }
+
+        if ((mode & FILEIO_SEARCH_SINGLE_ENTRY) == FILEIO_SEARCH_SINGLE_ENTRY)
+        {
+            return FILEIO_ERROR_DONE;
+        }
     }
 
 #if defined (__XC8__)
@@ -1449,6 +2147,9 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryCreate (FILEIO_OBJECT * filePtr, uint8_t
     FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
     uint32_t cluster;
 
+    // The file's directory isn't necessarily the current working directory, so search it from the start
+    globalParameters.currentWorkingDirectory.currentEntry = 0;
+
     if (FILEIO_DirectoryEntryFindEmpty(filePtr, &globalParameters.currentWorkingDirectory.currentEntry) == FILEIO_ERROR_NONE)
     {
         // Allocate a data cluster to the file object, if necessary
@@ -1476,6 +2177,13 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryCreate (FILEIO_OBJECT * filePtr, uint8_t
         {
             error = FILEIO_DirectoryEntryPopulate(filePtr, &globalParameters.currentWorkingDirectory.currentEntry, attributes, cluster);
         }
+
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+        if (error == FILEIO_ERROR_NONE)
+        {
+            FILEIO_DirectoryIndexAdd (filePtr->disk, filePtr->baseClusterDir, filePtr->entry, (uint8_t *)filePtr->name, filePtr->lfnPtr);
+        }
+#endif
     }
     else
     {
@@ -1494,7 +2202,7 @@ uint32_t FILEIO_CreateFirstCluster (FILEIO_OBJECT * filePtr)
     FILEIO_DRIVE * drive = filePtr->disk;
     uint32_t cluster;
 
-    cluster = FILEIO_FindEmptyCluster (filePtr->disk);
+    cluster = FILEIO_ClusterSelect (filePtr->disk, 0, 1);
 
     if (cluster == 0)
     {
@@ -1669,17 +2377,21 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryLFNCreate (FILEIO_OBJECT * filePtr, uint1
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
 bool FILEIO_AliasLFN (FILEIO_OBJECT * filePtr)
 {
-    uint32_t loopIndex, loopIndexEnd;
+    uint32_t firstTail, tail;
     int16_t   index1, extIndex, lfnIndex;
-    uint8_t  i, j;
+    uint8_t  i, j, tilde;
     uint8_t tempString[FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX];
+    uint8_t aliasString[FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX];
+    uint8_t usedTails[FILEIO_ALIAS_TAIL_WINDOW / 8];
     uint16_t * templfnPtr;
     uint16_t length;
     FILEIO_DIRECTORY directory;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
     uint32_t currentCluster;
     uint16_t currentClusterOffset;
+    uint16_t entryOffset;
     bool forceTail = false;
-    uint8_t tailLen = 0;
 
     templfnPtr = filePtr->lfnPtr;
     length = filePtr->lfnLen;
@@ -1776,96 +2488,130 @@ bool FILEIO_AliasLFN (FILEIO_OBJECT * filePtr)
     currentClusterOffset = 0;
 
     // See if the current short file name exists or if we need to force a tail because our LFN contained unconvertable unicode characters
-    if (forceTail || (FILEIO_FindShortFileName (&directory, filePtr, (uint8_t *)&filePtr->name, &currentCluster, &currentClusterOffset, 0, 0, FILEIO_SEARCH_ENTRY_MATCH) == FILEIO_ERROR_NONE))
+    if (!forceTail && (FILEIO_FindShortFileName (&directory, filePtr, (uint8_t *)&filePtr->name, &currentCluster, &currentClusterOffset, 0, 0, FILEIO_SEARCH_ENTRY_MATCH) != FILEIO_ERROR_NONE))
     {
-        memcpy (tempString, &filePtr->name, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
+        return true;
+    }
 
-        // The max number of name characters with a numeric index is 6
-        if (j > 6)
-        {
-            j = 6;
-        }
+    memcpy (tempString, &filePtr->name, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
 
-        loopIndex = 1;
-        
-        // Outer loop - Adjust the length of the tail and add the '~' character
-        for ( ; j > 0; j--)
+    // The max number of name characters with a numeric index is 6
+    if (j > 6)
+    {
+        j = 6;
+    }
+
+    if (j == 0)
+    {
+        return false;
+    }
+
+    // Read the directory once for each window of numeric tails, marking the tails that are already used by aliases
+    // with the same name, and use the first free one
+    for (firstTail = 1; firstTail < 1000000; firstTail += FILEIO_ALIAS_TAIL_WINDOW)
+    {
+        memset (usedTails, 0, sizeof (usedTails));
+
+        currentCluster = (directory.cluster == 0) ? directory.drive->firstRootCluster : directory.cluster;
+        currentClusterOffset = 0;
+        for (entryOffset = 0; ; entryOffset++)
         {
-            tempString[j] = '~';
-            switch (j)
+            entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, entryOffset);
+            if ((error == FILEIO_ERROR_DONE) || ((error == FILEIO_ERROR_NONE) && (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY)))
             {
-                case 6:
-                    tailLen = 2;
-                    loopIndexEnd = 10;
-                    break;
-                case 5:
-                    tailLen = 3;
-                    loopIndexEnd = 100;
-                    break;
-                case 4:
-                    tailLen = 4;
-                    loopIndexEnd = 1000;
-                    break;
-                case 3:
-                    tailLen = 5;
-                    loopIndexEnd = 10000;
-                    break;
-                case 2:
-                    tailLen = 6;
-                    loopIndexEnd = 100000;
-                    break;
-                case 1:
-                    tailLen = 7;
-                    loopIndexEnd = 1000000;
-                    break;
+                break;
+            }
+            else if (error != FILEIO_ERROR_NONE)
+            {
+                return false;
             }
 
-            // Inner loop - increase the value of the numeric index until we find one that isn't taken
-            for ( ; loopIndex < loopIndexEnd; loopIndex++)
+            if ((entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME) || (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED))
             {
-                currentCluster = directory.cluster;
-                currentClusterOffset = 0;
+                continue;
+            }
 
-                switch (tailLen)
-                {
-                    case 7:
-                        tempString[2] = (loopIndex % 1000000)/100000 + '0';
-                    case 6:
-                        tempString[3] = (loopIndex % 100000)/10000 + '0';
-                    case 5:
-                        tempString[4] = (loopIndex % 10000)/1000 + '0';
-                    case 4:
-                        tempString[5] = (loopIndex % 1000)/100 + '0';
-                    case 3:
-                        tempString[6] = (loopIndex % (uint8_t)100)/10 + '0';
-                    case 2:
-                        tempString[7] = loopIndex % (uint8_t)10 + '0';
-                        break;
-                }
+            // The tail is the digits after the last '~'
+            tilde = 7;
+            while ((tilde > 0) && (entry->name[tilde] != '~'))
+            {
+                tilde--;
+            }
+            for (tail = 0, i = tilde + 1; (tilde > 0) && (i < 8) && (entry->name[i] >= '0') && (entry->name[i] <= '9'); i++)
+            {
+                tail = (tail * 10) + (entry->name[i] - '0');
+            }
+
+            if ((tilde == 0) || (i != 8) || (tail < firstTail) || (tail >= firstTail + FILEIO_ALIAS_TAIL_WINDOW))
+            {
+                continue;
+            }
+
+            // Make sure the name is exactly the alias this tail would produce
+            memcpy (aliasString, tempString, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
+            if (FILEIO_AliasTailFormat (aliasString, j, tail) && (memcmp (aliasString, entry->name, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX) == 0))
+            {
+                usedTails[(tail - firstTail) / 8] |= 1 << ((tail - firstTail) % 8);
+            }
+        }
 
-                // See if the file is found
-                if(FILEIO_FindShortFileName (&directory, filePtr, tempString, &currentCluster, &currentClusterOffset, 0, 0, FILEIO_SEARCH_ENTRY_MATCH) == FILEIO_ERROR_DONE)
+        for (tail = firstTail; tail < firstTail + FILEIO_ALIAS_TAIL_WINDOW; tail++)
+        {
+            if ((usedTails[(tail - firstTail) / 8] & (1 << ((tail - firstTail) % 8))) == 0)
+            {
+                if (!FILEIO_AliasTailFormat (tempString, j, tail))
                 {
-                    memcpy (filePtr->name, tempString, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
-                    return true;
-                    break;
+                    return false;
                 }
+                memcpy (filePtr->name, tempString, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
+                return true;
             }
         }
     }
-    else
-    {
-        return true;
-    }
 
     return false;
 }
-#endif
 
-void FILEIO_ShortFileNameGet (FILEIO_OBJECT * filePtr, char * buffer)
+// Puts a numeric tail on an alias.  The tail follows at most six characters of the name ("~1" to "~9"), and takes
+// the place of another character each time it needs another digit ("~10" to "~99" after five characters, and so on).
+bool FILEIO_AliasTailFormat (uint8_t * name, uint8_t baseLength, uint32_t tail)
 {
-    FILEIO_ShortFileNameConvert (buffer, filePtr->name);
-}
+    uint32_t limit = 10;
+    uint8_t position = 6;
+    uint8_t i;
+
+    // Names shorter than six characters start with a longer, zero-padded tail
+    while (position > baseLength)
+    {
+        position--;
+        limit *= 10;
+    }
+
+    while (tail >= limit)
+    {
+        if (position <= 1)
+        {
+            return false;
+        }
+        position--;
+        limit *= 10;
+    }
+
+    name[position] = '~';
+    for (i = 7; i > position; i--)
+    {
+        name[i] = (tail % 10) + '0';
+        tail /= 10;
+    }
+
+    return true;
+}
+#endif
+
+void FILEIO_ShortFileNameGet (FILEIO_OBJECT * filePtr, char * buffer)
+{
+    FILEIO_ShortFileNameConvert (buffer, filePtr->name);
+}
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
 FILEIO_ERROR_TYPE FILEIO_DirectoryEntryPopulate(FILEIO_OBJECT * filePtr, uint16_t * entryHandle, uint8_t attributes, uint32_t cluster)
@@ -1945,12 +2691,14 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
     FILEIO_DIRECTORY_ENTRY * entry;
     FILEIO_DIRECTORY directory;
     uint32_t currentCluster = filePtr->baseClusterDir;
-    uint32_t tempCurrentCluster;
     uint16_t currentClusterOffset = 0;
     uint8_t fileEntryCount;
     uint8_t foundEntryCount;
     uint16_t tempHandle, tempHandle2;
     enum {NOT_FOUND, FOUND, ERROR} status = NOT_FOUND;
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+    FILEIO_FREE_ENTRY_HINT * hint;
+#endif
 
     directory.drive = filePtr->disk;
     directory.cluster = filePtr->baseClusterDir;
@@ -1971,6 +2719,16 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
 
     tempHandle2 = *entryOffset;
 
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+    // Skip the entries that are known to be in use, and the free run after them if it's known to be too small.  The
+    // search goes on from the end of that run, so the deleted entries after it can still be used.
+    hint = FILEIO_FreeEntryHintGet (&directory);
+    if ((hint != NULL) && (tempHandle2 == 0))
+    {
+        tempHandle2 = (hint->freeLength >= fileEntryCount) ? hint->firstFree : (hint->firstFree + hint->freeLength);
+    }
+#endif
+
     while (status == NOT_FOUND)
     {
         foundEntryCount = 0;
@@ -1979,7 +2737,6 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
         // Find [fileEntryCount] empty entries
         do
         {
-            tempCurrentCluster = currentCluster;
             entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, tempHandle2);
 
             tempHandle2++;
@@ -1993,8 +2750,11 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
             }
             else
             {
-                currentCluster = tempCurrentCluster;
-                if (FILEIO_ClusterAllocate (filePtr->disk, &currentCluster, true) == FILEIO_ERROR_DRIVE_FULL)
+                // Find the last cluster of the directory again, since the search may not have started at the first entry
+                currentCluster = filePtr->baseClusterDir;
+                currentClusterOffset = 0;
+                FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, tempHandle2 - 2);
+                if ((error != FILEIO_ERROR_NONE) || (FILEIO_ClusterAllocate (filePtr->disk, &currentCluster, 1, true) != FILEIO_ERROR_NONE))
                 {
                     status = ERROR;
                 }
@@ -2008,12 +2768,44 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
         {
             status = FOUND;
         }
+
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+        if ((status == ERROR) && (hint != NULL))
+        {
+            // The runs that were skipped may still have room
+            FILEIO_FreeEntryHintDrop (directory.drive, directory.cluster);
+            hint = NULL;
+            currentCluster = filePtr->baseClusterDir;
+            currentClusterOffset = 0;
+            tempHandle2 = *entryOffset;
+            status = NOT_FOUND;
+        }
+#endif
     }
 
     *entryOffset = tempHandle;
 
     if (status == FOUND)
     {
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+        if (hint != NULL)
+        {
+            if (tempHandle == hint->firstFree)
+            {
+                hint->firstFree += fileEntryCount;
+                hint->freeLength = (hint->freeLength > fileEntryCount) ? (hint->freeLength - fileEntryCount) : 0;
+            }
+            else if (fileEntryCount == 1)
+            {
+                // The search started at firstFree, so every entry up to this one was in use
+                hint->firstFree = tempHandle + 1;
+            }
+            if (tempHandle + fileEntryCount > hint->end)
+            {
+                hint->end = tempHandle + fileEntryCount;
+            }
+        }
+#endif
         return FILEIO_ERROR_NONE;
     }
     else
@@ -2021,255 +2813,1773 @@ FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint1
         return FILEIO_ERROR_DONE;
     }
 }
-#endif
 
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-FILEIO_ERROR_TYPE FILEIO_ClusterAllocate (FILEIO_DRIVE * drive, uint32_t * cluster, bool eraseCluster)
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+// Returns the free entry hint of a directory, reading the directory to make one if it doesn't have one.  Returns NULL
+// if the directory can't be read.
+FILEIO_FREE_ENTRY_HINT * FILEIO_FreeEntryHintGet (FILEIO_DIRECTORY * directory)
 {
-    uint32_t newCluster;
+    FILEIO_FREE_ENTRY_HINT * hint = gFreeEntryHints.hints;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint32_t cluster = directory->cluster;
+    uint32_t currentCluster;
+    uint16_t currentClusterOffset = 0;
+    uint16_t entryOffset, runStart = 0;
+    bool inRun = false;
+    uint8_t i;
 
-    newCluster = FILEIO_FindEmptyCluster (drive);
-    if (newCluster == 0)
+    if (cluster == 0)
     {
-        return FILEIO_ERROR_DRIVE_FULL;
+        cluster = directory->drive->firstRootCluster;
     }
 
-    if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT12)
+    for (i = 0; i < FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE; i++)
     {
-        FILEIO_FATWrite (drive, newCluster, FILEIO_CLUSTER_VALUE_FAT12_EOF, false);
-    }
-    else if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT16)
-    {
-        FILEIO_FATWrite (drive, newCluster, FILEIO_CLUSTER_VALUE_FAT16_EOF, false);
+        if ((gFreeEntryHints.hints[i].drive == directory->drive) && (gFreeEntryHints.hints[i].cluster == cluster))
+        {
+            gFreeEntryHints.hints[i].lastUse = ++gFreeEntryHints.useCount;
+            return gFreeEntryHints.hints + i;
+        }
     }
-    else if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+
+    // Use a free hint, or replace the one that was used least recently
+    for (i = 0; i < FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE; i++)
     {
-        FILEIO_FATWrite (drive, newCluster, FILEIO_CLUSTER_VALUE_FAT32_EOF, false);
+        if (gFreeEntryHints.hints[i].drive == NULL)
+        {
+            hint = gFreeEntryHints.hints + i;
+            break;
+        }
+        if (gFreeEntryHints.hints[i].lastUse < hint->lastUse)
+        {
+            hint = gFreeEntryHints.hints + i;
+        }
     }
 
-    FILEIO_FATWrite (drive, *cluster, newCluster, false);
-
-    *cluster = newCluster;
+    hint->drive = NULL;
+    hint->freeLength = 0;
 
-    if (eraseCluster)
+    // Find the first run of free entries and the start of the free entries at the end of the directory
+    currentCluster = cluster;
+    for (entryOffset = 0; ; entryOffset++)
     {
-        return FILEIO_EraseCluster (drive, newCluster);
+        entry = FILEIO_DirectoryEntryCache (directory, &error, &currentCluster, &currentClusterOffset, entryOffset);
+        if ((error == FILEIO_ERROR_DONE) || ((error == FILEIO_ERROR_NONE) && (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY)))
+        {
+            break;
+        }
+        else if (error != FILEIO_ERROR_NONE)
+        {
+            return NULL;
+        }
+
+        if (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED)
+        {
+            if (!inRun)
+            {
+                runStart = entryOffset;
+                inRun = true;
+            }
+        }
+        else if (inRun)
+        {
+            if (hint->freeLength == 0)
+            {
+                hint->firstFree = runStart;
+                hint->freeLength = entryOffset - runStart;
+            }
+            inRun = false;
+        }
     }
-    else
+
+    hint->drive = directory->drive;
+    hint->cluster = cluster;
+    hint->lastUse = ++gFreeEntryHints.useCount;
+    hint->end = inRun ? runStart : entryOffset;
+    if (hint->freeLength == 0)
     {
-        return FILEIO_ERROR_NONE;
+        hint->firstFree = hint->end;
     }
+
+    return hint;
 }
-#endif
 
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-uint32_t FILEIO_FindEmptyCluster (FILEIO_DRIVE * drive)
+// Records that entries of a directory were erased
+void FILEIO_FreeEntryHintRelease (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry, uint16_t count)
 {
-    uint32_t cluster = 0x0;
-    uint32_t currentCluster, endClusterLimit, clusterFailValue;
-    uint32_t baseCluster = drive->currentCluster;
+    FILEIO_FREE_ENTRY_HINT * hint;
+    uint8_t i;
 
-    /* Settings based on FAT type */
-    switch (drive->type)
+    if (cluster == 0)
     {
-        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
-            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT32_END;
-            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
-            break;
-        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
-            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT12_END;
-            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
-            break;
-        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
-        default:
-            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT16_END;
-            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
-            break;
+        cluster = drive->firstRootCluster;
     }
 
-    // just in case
-    if(baseCluster < 2)
-        baseCluster = 2;
+    for (i = 0, hint = gFreeEntryHints.hints; i < FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE; i++, hint++)
+    {
+        if ((hint->drive != drive) || (hint->cluster != cluster))
+        {
+            continue;
+        }
 
-    currentCluster = baseCluster;
+        if (entry < hint->firstFree)
+        {
+            hint->freeLength = ((entry + count == hint->firstFree) && (hint->freeLength != 0)) ? (hint->freeLength + count) : count;
+            hint->firstFree = entry;
+        }
+        else if ((hint->freeLength != 0) && (hint->firstFree + hint->freeLength == entry))
+        {
+            hint->freeLength += count;
+        }
 
-    // sequentially scan through the FAT looking for an empty cluster
-    while(currentCluster)
-    {
-        // look at its value
-        if ((cluster = FILEIO_FATRead(drive, currentCluster)) == clusterFailValue)
+        if (entry + count == hint->end)
         {
-            currentCluster = 0;
-            break;
+            hint->end = entry;
+            // The first free run may now reach the end of the directory
+            if ((hint->freeLength != 0) && (hint->firstFree + hint->freeLength >= hint->end))
+            {
+                hint->end = hint->firstFree;
+                hint->freeLength = 0;
+            }
         }
+        return;
+    }
+}
 
-        // check if empty cluster found
-        if (cluster == FILEIO_CLUSTER_VALUE_EMPTY)
-            break;
+void FILEIO_FreeEntryHintDrop (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    uint8_t i;
 
-        currentCluster++;    // check next cluster in FAT
+    if (cluster == 0)
+    {
+        cluster = drive->firstRootCluster;
+    }
 
-        // check if reached last cluster in FAT, re-start from top
-        if ((cluster == endClusterLimit) || (currentCluster >= (drive->partitionClusterCount + 2)))
+    for (i = 0; i < FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE; i++)
+    {
+        if ((gFreeEntryHints.hints[i].drive == drive) && (gFreeEntryHints.hints[i].cluster == cluster))
         {
-            currentCluster = 2;
+            gFreeEntryHints.hints[i].drive = NULL;
         }
+    }
+}
 
-        // check if full circle done, disk full
-        if ( currentCluster == baseCluster)
+void FILEIO_FreeEntryHintDriveDrop (FILEIO_DRIVE * drive)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE; i++)
+    {
+        if (gFreeEntryHints.hints[i].drive == drive)
         {
-            currentCluster = 0;
-            break;
+            gFreeEntryHints.hints[i].drive = NULL;
         }
-    }  // scanning for an empty cluster
-    
-    drive->currentCluster = currentCluster;
-    
-    return(currentCluster);
+    }
 }
 #endif
+#endif
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-FILEIO_ERROR_TYPE FILEIO_EraseCluster (FILEIO_DRIVE * drive, uint32_t cluster)
+FILEIO_ERROR_TYPE FILEIO_ClusterAllocate (FILEIO_DRIVE * drive, uint32_t * cluster, uint32_t count, bool eraseCluster)
 {
-    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
-    uint32_t sector = FILEIO_ClusterToSector (drive, cluster);
-    uint8_t i;
+    FILEIO_ERROR_TYPE error;
+    uint32_t newCluster;
 
-    if (!FILEIO_FlushBuffer (drive, FILEIO_BUFFER_DATA))
+    newCluster = FILEIO_ClusterSelect (drive, *cluster, count);
+    if (newCluster == 0)
     {
-        drive->error = FILEIO_ERROR_WRITE;
-        return FILEIO_ERROR_WRITE;
+        return FILEIO_ERROR_DRIVE_FULL;
     }
 
-    memset (drive->dataBuffer, 0x00, drive->sectorSize);
-
-    for (i = 0; (i < drive->sectorsPerCluster) && (error == FILEIO_ERROR_NONE); i++)
+    if ((error = FILEIO_FATChainExtend (drive, *cluster, &newCluster, 1)) != FILEIO_ERROR_NONE)
     {
-        if (!(*drive->driveConfig->funcSectorWrite)(drive->mediaParameters, sector++, drive->dataBuffer, false))
-        {
-            error = FILEIO_ERROR_WRITE;
-        }
+        return error;
     }
 
-    // As an optimization, set the cached sector to the first sector of the cluster.  They're all zero anyway, now.
-    drive->bufferStatusPtr->dataBufferCachedSector = sector - drive->sectorsPerCluster;
-    drive->bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+    *cluster = newCluster;
 
-    drive->error = error;
-    return error;
+    if (eraseCluster)
+    {
+        return FILEIO_EraseCluster (drive, newCluster);
+    }
+    else
+    {
+        return FILEIO_ERROR_NONE;
+    }
 }
 #endif
 
-FILEIO_DIRECTORY_ENTRY * FILEIO_DirectoryEntryCache (FILEIO_DIRECTORY * directory, FILEIO_ERROR_TYPE * error, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset)
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+// Allocates the cluster at 'index' in the file, which must follow the last cluster of its chain (filePtr->currentCluster).
+// The free clusters right after it are claimed for the file too, up to the larger of 'count' and the allocation window,
+// so the file stays contiguous when other files are growing at the same time.  FILEIO_Close frees the claimed clusters
+// that the file doesn't grow into.
+FILEIO_ERROR_TYPE FILEIO_FileClustersAllocate (FILEIO_OBJECT * filePtr, uint32_t index, uint32_t count)
 {
-    FILEIO_DRIVE * disk = directory->drive;
-    FILEIO_DIRECTORY_ENTRY * entry;
-    uint8_t directoryEntriesPerSector = disk->sectorSize / FILEIO_DIRECTORY_ENTRY_SIZE;
-    uint16_t totalSectorOffset = entryOffset / directoryEntriesPerSector;
-    uint32_t sector;
+    FILEIO_DRIVE * disk = filePtr->disk;
+    FILEIO_ERROR_TYPE error;
+    uint32_t clusters[FILEIO_FAT_CHAIN_BATCH_SIZE];
+    uint32_t previous = filePtr->currentCluster;
+    uint32_t first, length, i;
+    uint16_t j, batch;
 
-    if ((disk->type != FILEIO_FILE_SYSTEM_TYPE_FAT32) && (*currentCluster == FILEIO_FIXED_ROOT_DIRECTORY_CLUSTER_NUMBER))
+    if (count < FILEIO_CONFIG_ALLOCATION_WINDOW)
     {
-        if (entryOffset >= disk->rootDirectoryEntryCount)
+        count = FILEIO_CONFIG_ALLOCATION_WINDOW;
+    }
+
+    if ((first = FILEIO_ClusterSelect (disk, previous, count)) == 0)
+    {
+        return FILEIO_ERROR_DRIVE_FULL;
+    }
+
+    // Count the free clusters that follow the new one
+    for (length = 1; (length < count) && (first + length < disk->partitionClusterCount + 2); length++)
+    {
+        if (FILEIO_FATRead (disk, first + length) != FILEIO_CLUSTER_VALUE_EMPTY)
         {
-            *error = FILEIO_ERROR_DONE;
-            return NULL;
+            break;
         }
-        // We're looking for the file in the FAT12/16 root directory
-        sector = FILEIO_ClusterToSector (directory->drive, directory->cluster);
-        sector += totalSectorOffset;
     }
-    else
+
+    // Add the clusters to the file a batch at a time
+    for (i = 0; i < length; i += batch)
     {
-        // Find the cluster/sector with the specified directory entry offset
-        uint16_t totalClusterOffset = totalSectorOffset / disk->sectorsPerCluster;
-        if (*currentClusterOffset > totalClusterOffset)
+        batch = ((length - i) > FILEIO_FAT_CHAIN_BATCH_SIZE) ? FILEIO_FAT_CHAIN_BATCH_SIZE : (uint16_t)(length - i);
+        for (j = 0; j < batch; j++)
         {
-            *currentClusterOffset = 0;
-            *currentCluster = directory->cluster;
+            clusters[j] = first + i + j;
         }
 
-        totalSectorOffset -= (disk->sectorsPerCluster * (*currentClusterOffset));
-
-        while (*currentClusterOffset < totalClusterOffset)
+        if ((error = FILEIO_FATChainExtend (disk, previous, clusters, batch)) != FILEIO_ERROR_NONE)
         {
-            *currentCluster = FILEIO_FATRead (disk, *currentCluster);
-            // Switch based on FAT type
-            switch (disk->type)
-            {
-                case FILEIO_FILE_SYSTEM_TYPE_FAT32:
-                    if (*currentCluster == FILEIO_CLUSTER_VALUE_FAT32_EOF)
-                    {
-                        *error = FILEIO_ERROR_DONE;
-                        return NULL;
-                    }
-                    break;
-                case FILEIO_FILE_SYSTEM_TYPE_FAT12:
-                case FILEIO_FILE_SYSTEM_TYPE_FAT16:
-                default:
-                    if (*currentCluster == FILEIO_CLUSTER_VALUE_FAT16_EOF)
-                    {
-                        *error = FILEIO_ERROR_DONE;
-                        return NULL;
-                    }
-                    break;
-            }
-            *currentClusterOffset = *currentClusterOffset + 1;
-            totalSectorOffset -= disk->sectorsPerCluster;
+            return error;
         }
+        previous = clusters[batch - 1];
 
-        // currentCluster points to the cluster we need.  Convert to sectors and add the sector offset.
-        sector = FILEIO_ClusterToSector (disk, *currentCluster);
-        sector += totalSectorOffset;
-    }
-
-    if (disk->bufferStatusPtr->dataBufferCachedSector != sector)
-    {
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-        if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_DATA))
+        for (j = 0; j < batch; j++)
         {
-            *error = FILEIO_ERROR_WRITE;
-            return NULL;
+            FILEIO_ExtentMapAdd (filePtr, index + i + j, clusters[j]);
         }
-#endif
-        if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector, disk->dataBuffer) != true)
+
+        if (i == 0)
         {
-            *error = FILEIO_ERROR_BAD_SECTOR_READ;
-            return NULL;
+            // The first cluster is the one the caller needs; the rest are claimed ahead of it
+            filePtr->currentCluster = first;
+            filePtr->windowStart = index + 1;
+        }
+        filePtr->windowEnd = index + i + batch;
+        disk->currentCluster = previous;
+    }
+
+    return FILEIO_ERROR_NONE;
+}
+
+// Frees the clusters claimed by FILEIO_FileClustersAllocate that the file didn't grow into, and the tail of a chain
+// reused by FILEIO_OPEN_REWRITE that the new contents didn't fill
+FILEIO_ERROR_TYPE FILEIO_FileClustersRelease (FILEIO_OBJECT * filePtr)
+{
+    FILEIO_DRIVE * disk = filePtr->disk;
+    uint32_t clusterSize = (uint32_t)disk->sectorSize * disk->sectorsPerCluster;
+    uint32_t keep, next;
+
+    // Keep every cluster that holds data, and every cluster before the window
+    keep = (filePtr->size == 0) ? 1 : (((filePtr->size - 1) / clusterSize) + 1);
+    if (keep < filePtr->windowStart)
+    {
+        keep = filePtr->windowStart;
+    }
+
+    next = filePtr->windowEnd;
+    filePtr->windowStart = 0;
+    filePtr->windowEnd = 0;
+
+    if (!filePtr->flags.truncateOnClose && (keep >= next))
+    {
+        return FILEIO_ERROR_NONE;
+    }
+    filePtr->flags.truncateOnClose = false;
+
+    return FILEIO_FileClustersTruncate (filePtr, keep);
+}
+
+// Keeps the first 'count' clusters of the file's chain and frees the rest of it
+FILEIO_ERROR_TYPE FILEIO_FileClustersTruncate (FILEIO_OBJECT * filePtr, uint32_t count)
+{
+    FILEIO_DRIVE * disk = filePtr->disk;
+    FILEIO_ERROR_TYPE error;
+    uint32_t next, eofValue, clusterFailValue;
+    uint16_t i;
+
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    if (FILEIO_GetSingleBuffer (disk) != FILEIO_RESULT_SUCCESS)
+    {
+        return FILEIO_ERROR_WRITE;
+    }
+#endif
+
+    switch (disk->type)
+    {
+        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT12_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT32_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+        default:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT16_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+    }
+
+    // Terminate the chain after the last cluster that is kept, and free the rest of it
+    if ((error = FILEIO_FileClusterGet (filePtr, count - 1)) != FILEIO_ERROR_NONE)
+    {
+        return (error == FILEIO_ERROR_EOF) ? FILEIO_ERROR_INVALID_CLUSTER : error;
+    }
+
+    if ((next = FILEIO_FATRead (disk, filePtr->currentCluster)) == clusterFailValue)
+    {
+        return FILEIO_ERROR_BAD_SECTOR_READ;
+    }
+
+    if (next >= eofValue)
+    {
+        return FILEIO_ERROR_NONE;
+    }
+
+    if (FILEIO_FATWrite (disk, filePtr->currentCluster, eofValue, false) == clusterFailValue)
+    {
+        return FILEIO_ERROR_WRITE;
+    }
+
+    // Drop the freed clusters from the extent map
+    for (i = 0; i < filePtr->extentCount; i++)
+    {
+        if (filePtr->extentMap[i].fileCluster >= count)
+        {
+            filePtr->extentCount = i;
+            break;
+        }
+        if (filePtr->extentMap[i].fileCluster + filePtr->extentMap[i].length > count)
+        {
+            filePtr->extentMap[i].length = count - filePtr->extentMap[i].fileCluster;
+        }
+    }
+
+    error = FILEIO_EraseClusterChain (next, disk);
+
+    return ((error == FILEIO_ERROR_DONE) || (error == FILEIO_ERROR_NONE)) ? FILEIO_ERROR_NONE : error;
+}
+
+int FILEIO_AllocationPolicySet (uint16_t driveId, FILEIO_ALLOCATION_POLICY policy)
+{
+    FILEIO_DRIVE * drive = FILEIO_CharToDrive (driveId);
+
+    if (drive == NULL)
+    {
+        return FILEIO_RESULT_FAILURE;
+    }
+
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    if ((policy != FILEIO_ALLOCATION_NEXT_FIT) && (policy != FILEIO_ALLOCATION_FIRST_FIT_RUN) && (policy != FILEIO_ALLOCATION_BEST_FIT_RUN))
+#else
+    if (policy != FILEIO_ALLOCATION_NEXT_FIT)
+#endif
+    {
+        drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    drive->allocationPolicy = policy;
+
+    return FILEIO_RESULT_SUCCESS;
+}
+
+int FILEIO_FATMirroringSet (uint16_t driveId, FILEIO_FAT_MIRRORING mode)
+{
+    FILEIO_DRIVE * drive = FILEIO_CharToDrive (driveId);
+
+    if (drive == NULL)
+    {
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    if ((mode != FILEIO_FAT_MIRRORING_IMMEDIATE) && (mode != FILEIO_FAT_MIRRORING_DEFERRED))
+    {
+        drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    // Bring the secondary copies up to date before they are written directly again
+    if ((mode == FILEIO_FAT_MIRRORING_IMMEDIATE) && (drive->fatMirroring == FILEIO_FAT_MIRRORING_DEFERRED))
+    {
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+        if (FILEIO_GetSingleBuffer (drive) != FILEIO_RESULT_SUCCESS)
+        {
+            drive->error = FILEIO_ERROR_WRITE;
+            return FILEIO_RESULT_FAILURE;
+        }
+#endif
+        if (!FILEIO_FATMirrorSync (drive))
+        {
+            drive->error = FILEIO_ERROR_WRITE;
+            return FILEIO_RESULT_FAILURE;
+        }
+    }
+
+    drive->fatMirroring = mode;
+
+    return FILEIO_RESULT_SUCCESS;
+}
+
+int FILEIO_Sync (uint16_t driveId)
+{
+    FILEIO_DRIVE * drive = FILEIO_CharToDrive (driveId);
+
+    if (drive == NULL)
+    {
+        return FILEIO_RESULT_FAILURE;
+    }
+
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    if (FILEIO_GetSingleBuffer (drive) != FILEIO_RESULT_SUCCESS)
+    {
+        drive->error = FILEIO_ERROR_WRITE;
+        return FILEIO_RESULT_FAILURE;
+    }
+#endif
+
+    if (!FILEIO_FlushBuffer (drive, FILEIO_BUFFER_DATA) || !FILEIO_FSInfoWrite (drive) || !FILEIO_FATMirrorSync (drive))
+    {
+        drive->error = FILEIO_ERROR_WRITE;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    return FILEIO_RESULT_SUCCESS;
+}
+
+// Chooses the cluster to allocate after previousCluster, or for a new chain if previousCluster is 0.  'count' is the
+// number of clusters the caller expects to need, including this one.
+uint32_t FILEIO_ClusterSelect (FILEIO_DRIVE * drive, uint32_t previousCluster, uint32_t count)
+{
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    FILEIO_FREE_EXTENT * extent;
+    uint32_t cluster, endClusterLimit;
+
+    if (drive->allocationPolicy != FILEIO_ALLOCATION_NEXT_FIT)
+    {
+        // Keep the chain contiguous if the cluster after it is free
+        cluster = previousCluster + 1;
+        if ((previousCluster >= 2) && (cluster < drive->partitionClusterCount + 2) && (FILEIO_FATRead (drive, cluster) == FILEIO_CLUSTER_VALUE_EMPTY))
+        {
+            drive->currentCluster = cluster;
+            return cluster;
+        }
+
+        // Otherwise start a new run
+        if ((extent = FILEIO_FreeExtentSelect (drive, count)) != NULL)
+        {
+            cluster = extent->start;
+
+            // If another chain got in the way of this one, it probably ends right before the run and is still growing.
+            // Leave it half of the spare room so the two chains don't keep running into each other.
+            if ((previousCluster != 0) && (extent->length > count))
+            {
+                switch (drive->type)
+                {
+                    case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+                        endClusterLimit = FILEIO_CLUSTER_VALUE_FAT32_END;
+                        break;
+                    case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+                        endClusterLimit = FILEIO_CLUSTER_VALUE_FAT12_END;
+                        break;
+                    case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+                    default:
+                        endClusterLimit = FILEIO_CLUSTER_VALUE_FAT16_END;
+                        break;
+                }
+
+                if ((cluster > 2) && (FILEIO_FATRead (drive, cluster - 1) > endClusterLimit))
+                {
+                    cluster += (extent->length - count) / 2;
+                }
+            }
+
+            drive->currentCluster = cluster;
+            return cluster;
+        }
+        else if (drive->freeExtentsValid && drive->freeExtentsComplete)
+        {
+            // The index describes every free cluster, so the drive is full
+            return 0;
+        }
+    }
+#endif
+
+    return FILEIO_FindEmptyCluster (drive);
+}
+#endif
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+uint32_t FILEIO_FindEmptyCluster (FILEIO_DRIVE * drive)
+{
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE)
+    return FILEIO_ClusterBitmapFind (drive);
+#else
+    uint32_t cluster = 0x0;
+    uint32_t currentCluster, endClusterLimit, clusterFailValue;
+    uint32_t baseCluster = drive->currentCluster;
+
+    /* Settings based on FAT type */
+    switch (drive->type)
+    {
+        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT32_END;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT12_END;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+        default:
+            endClusterLimit = FILEIO_CLUSTER_VALUE_FAT16_END;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+    }
+
+    // just in case
+    if(baseCluster < 2)
+        baseCluster = 2;
+
+    currentCluster = baseCluster;
+
+    // sequentially scan through the FAT looking for an empty cluster
+    while(currentCluster)
+    {
+        // look at its value
+        if ((cluster = FILEIO_FATRead(drive, currentCluster)) == clusterFailValue)
+        {
+            currentCluster = 0;
+            break;
+        }
+
+        // check if empty cluster found
+        if (cluster == FILEIO_CLUSTER_VALUE_EMPTY)
+            break;
+
+        currentCluster++;    // check next cluster in FAT
+
+        // check if reached last cluster in FAT, re-start from top
+        if ((cluster == endClusterLimit) || (currentCluster >= (drive->partitionClusterCount + 2)))
+        {
+            currentCluster = 2;
+        }
+
+        // check if full circle done, disk full
+        if ( currentCluster == baseCluster)
+        {
+            currentCluster = 0;
+            break;
+        }
+    }  // scanning for an empty cluster
+    
+    drive->currentCluster = currentCluster;
+    
+    return(currentCluster);
+#endif
+}
+#endif
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+// Looks for a run of 'count' free clusters, scanning the FAT from baseCluster and wrapping around once.  If there
+// is no run that long, the longest run found is returned instead; a length of 0 means the disk is full.
+FILEIO_ERROR_TYPE FILEIO_FreeRunFind (FILEIO_DRIVE * drive, uint32_t baseCluster, uint32_t count, uint32_t * start, uint32_t * length)
+{
+    uint32_t endCluster = drive->partitionClusterCount + 2;
+    uint32_t cluster, value, clusterFailValue, scanned;
+    uint32_t runStart = 0, runLength = 0;
+
+    if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+    }
+    else
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+    }
+
+    *start = 0;
+    *length = 0;
+
+    if ((baseCluster < 2) || (baseCluster >= endCluster))
+    {
+        baseCluster = 2;
+    }
+
+    cluster = baseCluster;
+    for (scanned = 0; scanned < drive->partitionClusterCount; scanned++)
+    {
+        if ((value = FILEIO_FATRead (drive, cluster)) == clusterFailValue)
+        {
+            return FILEIO_ERROR_BAD_SECTOR_READ;
+        }
+
+        if (value == FILEIO_CLUSTER_VALUE_EMPTY)
+        {
+            if (runLength++ == 0)
+            {
+                runStart = cluster;
+            }
+
+            if (runLength == count)
+            {
+                *start = runStart;
+                *length = runLength;
+                return FILEIO_ERROR_NONE;
+            }
+        }
+        else
+        {
+            runLength = 0;
+        }
+
+        if (runLength > *length)
+        {
+            *start = runStart;
+            *length = runLength;
+        }
+
+        // A run can't wrap around the end of the FAT
+        if (++cluster == endCluster)
+        {
+            cluster = 2;
+            runLength = 0;
+        }
+    }
+
+    return FILEIO_ERROR_NONE;
+}
+#endif
+
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+FILEIO_ERROR_TYPE FILEIO_FreeExtentIndexBuild (FILEIO_DRIVE * drive)
+{
+    uint32_t endCluster = drive->partitionClusterCount + 2;
+    uint32_t cluster, value, clusterFailValue;
+    uint32_t runStart = 0, runLength = 0;
+
+    if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+    }
+    else
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+    }
+
+    drive->freeExtentsValid = false;
+    drive->freeExtentCount = 0;
+    drive->freeExtentsComplete = true;
+
+    // Go one cluster past the end of the FAT so the last run is recorded
+    for (cluster = 2; cluster <= endCluster; cluster++)
+    {
+        if (cluster < endCluster)
+        {
+            if ((value = FILEIO_FATRead (drive, cluster)) == clusterFailValue)
+            {
+                return FILEIO_ERROR_BAD_SECTOR_READ;
+            }
+
+            if (value == FILEIO_CLUSTER_VALUE_EMPTY)
+            {
+                if (runLength++ == 0)
+                {
+                    runStart = cluster;
+                }
+                continue;
+            }
+        }
+
+        if (runLength != 0)
+        {
+            FILEIO_FreeExtentInsert (drive, runStart, runLength);
+            runLength = 0;
+        }
+    }
+
+    drive->freeExtentsValid = true;
+
+    return FILEIO_ERROR_NONE;
+}
+
+// Adds a free run to the index, keeping it sorted by first cluster.  If the index is full the smallest run is dropped,
+// which may be the new one.
+void FILEIO_FreeExtentInsert (FILEIO_DRIVE * drive, uint32_t start, uint32_t length)
+{
+    FILEIO_FREE_EXTENT * extents = drive->freeExtents;
+    uint8_t i, smallest;
+
+    if (drive->freeExtentCount == FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    {
+        smallest = 0;
+        for (i = 1; i < drive->freeExtentCount; i++)
+        {
+            if (extents[i].length < extents[smallest].length)
+            {
+                smallest = i;
+            }
+        }
+
+        drive->freeExtentsComplete = false;
+
+        if (extents[smallest].length >= length)
+        {
+            return;
+        }
+
+        drive->freeExtentCount--;
+        for (i = smallest; i < drive->freeExtentCount; i++)
+        {
+            extents[i] = extents[i + 1];
+        }
+    }
+
+    for (i = drive->freeExtentCount; (i > 0) && (extents[i - 1].start > start); i--)
+    {
+        extents[i] = extents[i - 1];
+    }
+    extents[i].start = start;
+    extents[i].length = length;
+    drive->freeExtentCount++;
+}
+
+// Returns the free run that the allocation policy picks for a request of 'count' clusters, or NULL if there are no
+// free runs in the index.  An empty index is only rebuilt if some free clusters may have been left out of it.
+FILEIO_FREE_EXTENT * FILEIO_FreeExtentSelect (FILEIO_DRIVE * drive, uint32_t count)
+{
+    FILEIO_FREE_EXTENT * extent;
+    FILEIO_FREE_EXTENT * fit = NULL;
+    FILEIO_FREE_EXTENT * largest = NULL;
+    uint8_t i;
+
+    if (!drive->freeExtentsValid || ((drive->freeExtentCount == 0) && !drive->freeExtentsComplete))
+    {
+        if (FILEIO_FreeExtentIndexBuild (drive) != FILEIO_ERROR_NONE)
+        {
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < drive->freeExtentCount; i++)
+    {
+        extent = &drive->freeExtents[i];
+        if ((largest == NULL) || (extent->length > largest->length))
+        {
+            largest = extent;
+        }
+
+        if (extent->length >= count)
+        {
+            // The index is sorted, so the first run that fits is the lowest one
+            if (drive->allocationPolicy == FILEIO_ALLOCATION_FIRST_FIT_RUN)
+            {
+                return extent;
+            }
+
+            if ((fit == NULL) || (extent->length < fit->length))
+            {
+                fit = extent;
+            }
+        }
+    }
+
+    return (fit == NULL) ? largest : fit;
+}
+
+// Keeps the free extent index consistent with the FAT when a cluster changes between free and allocated.  The index
+// only describes free clusters, but it doesn't have to describe all of them.
+void FILEIO_FreeExtentUpdate (FILEIO_DRIVE * drive, uint32_t cluster, bool allocated)
+{
+    FILEIO_FREE_EXTENT * extents = drive->freeExtents;
+    uint32_t end;
+    uint8_t i, j;
+
+    if (!drive->freeExtentsValid)
+    {
+        return;
+    }
+
+    // Find the first run that ends at or after the cluster
+    for (i = 0; (i < drive->freeExtentCount) && (extents[i].start + extents[i].length < cluster); i++);
+
+    if (allocated)
+    {
+        if ((i < drive->freeExtentCount) && (cluster == extents[i].start + extents[i].length))
+        {
+            i++;
+        }
+
+        if ((i == drive->freeExtentCount) || (cluster < extents[i].start))
+        {
+            return;
+        }
+
+        end = extents[i].start + extents[i].length;
+        if (cluster == extents[i].start)
+        {
+            extents[i].start++;
+            if (--extents[i].length == 0)
+            {
+                drive->freeExtentCount--;
+                for (j = i; j < drive->freeExtentCount; j++)
+                {
+                    extents[j] = extents[j + 1];
+                }
+            }
+        }
+        else if (cluster == end - 1)
+        {
+            extents[i].length--;
+        }
+        else
+        {
+            // Split the run.  If there's no room for both halves, keep the larger one.
+            extents[i].length = cluster - extents[i].start;
+            if (drive->freeExtentCount < FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+            {
+                for (j = drive->freeExtentCount; j > i + 1; j--)
+                {
+                    extents[j] = extents[j - 1];
+                }
+                drive->freeExtentCount++;
+                i++;
+            }
+            else
+            {
+                drive->freeExtentsComplete = false;
+                if (end - cluster - 1 <= extents[i].length)
+                {
+                    return;
+                }
+            }
+            extents[i].start = cluster + 1;
+            extents[i].length = end - cluster - 1;
+        }
+    }
+    else
+    {
+        if ((i < drive->freeExtentCount) && (cluster == extents[i].start + extents[i].length))
+        {
+            // Grow the run, and merge it with the next one if the gap between them is closed
+            extents[i].length++;
+            if ((i + 1 < drive->freeExtentCount) && (extents[i + 1].start == cluster + 1))
+            {
+                extents[i].length += extents[i + 1].length;
+                drive->freeExtentCount--;
+                for (j = i + 1; j < drive->freeExtentCount; j++)
+                {
+                    extents[j] = extents[j + 1];
+                }
+            }
+        }
+        else if ((i < drive->freeExtentCount) && (cluster + 1 == extents[i].start))
+        {
+            extents[i].start--;
+            extents[i].length++;
+        }
+        else if (drive->freeExtentCount < FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+        {
+            for (j = drive->freeExtentCount; j > i; j--)
+            {
+                extents[j] = extents[j - 1];
+            }
+            extents[i].start = cluster;
+            extents[i].length = 1;
+            drive->freeExtentCount++;
+        }
+        else
+        {
+            drive->freeExtentsComplete = false;
+        }
+    }
+}
+#endif
+
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+FILEIO_ERROR_TYPE FILEIO_ClusterBitmapLoad (FILEIO_DRIVE * drive, uint32_t baseCluster)
+{
+    uint32_t cluster, value, clusterFailValue;
+    uint32_t endCluster = drive->partitionClusterCount + 2;
+    uint16_t i;
+
+    if (drive->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+    }
+    else
+    {
+        clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+    }
+
+    drive->clusterBitmapValid = false;
+    drive->clusterBitmapBase = baseCluster;
+    drive->clusterBitmapFree = 0;
+
+    for (i = 0; i < FILEIO_CLUSTER_BITMAP_WORDS; i++)
+    {
+        drive->clusterBitmap[i] = 0;
+    }
+
+    // Mark every allocated cluster in the window.  Bits past the end of the FAT are marked as allocated.
+    for (cluster = baseCluster; cluster < baseCluster + FILEIO_CLUSTER_BITMAP_BITS; cluster++)
+    {
+        if (cluster < endCluster)
+        {
+            if ((value = FILEIO_FATRead (drive, cluster)) == clusterFailValue)
+            {
+                return FILEIO_ERROR_BAD_SECTOR_READ;
+            }
+
+            if (value == FILEIO_CLUSTER_VALUE_EMPTY)
+            {
+                drive->clusterBitmapFree++;
+                continue;
+            }
+        }
+        i = (uint16_t)((cluster - baseCluster) >> 5);
+        drive->clusterBitmap[i] |= (uint32_t)1 << ((cluster - baseCluster) & 0x1F);
+    }
+
+    drive->clusterBitmapValid = true;
+
+    return FILEIO_ERROR_NONE;
+}
+
+uint32_t FILEIO_ClusterBitmapFind (FILEIO_DRIVE * drive)
+{
+    uint32_t endCluster = drive->partitionClusterCount + 2;
+    uint32_t window, windowCount, word;
+    uint16_t i, index, start;
+    uint8_t bit;
+
+    // Check every window once, and the first window a second time in case the search started in the middle of it
+    windowCount = (drive->partitionClusterCount + FILEIO_CLUSTER_BITMAP_BITS - 1) / FILEIO_CLUSTER_BITMAP_BITS;
+    for (window = 0; window <= windowCount; window++)
+    {
+        if (!drive->clusterBitmapValid)
+        {
+            if (FILEIO_ClusterBitmapLoad (drive, drive->clusterBitmapBase) != FILEIO_ERROR_NONE)
+            {
+                return 0;
+            }
+        }
+
+        if (drive->clusterBitmapFree != 0)
+        {
+            // Start at the word containing the allocation hint, if the hint is in this window
+            start = 0;
+            if ((drive->currentCluster >= drive->clusterBitmapBase) && (drive->currentCluster < drive->clusterBitmapBase + FILEIO_CLUSTER_BITMAP_BITS))
+            {
+                start = (uint16_t)((drive->currentCluster - drive->clusterBitmapBase) >> 5);
+            }
+
+            for (i = 0; i < FILEIO_CLUSTER_BITMAP_WORDS; i++)
+            {
+                index = start + i;
+                if (index >= FILEIO_CLUSTER_BITMAP_WORDS)
+                {
+                    index -= FILEIO_CLUSTER_BITMAP_WORDS;
+                }
+
+                word = drive->clusterBitmap[index];
+                if (word != 0xFFFFFFFF)
+                {
+                    // Find the first zero bit
+                    for (bit = 0; (word & 0x01) != 0; bit++)
+                    {
+                        word >>= 1;
+                    }
+
+                    drive->currentCluster = drive->clusterBitmapBase + ((uint32_t)index << 5) + bit;
+                    return drive->currentCluster;
+                }
+            }
+        }
+
+        // This window is full.  If it covers the whole FAT, so is the disk.
+        if (windowCount == 1)
+        {
+            return 0;
+        }
+
+        // Move on to the next window
+        drive->clusterBitmapBase += FILEIO_CLUSTER_BITMAP_BITS;
+        if (drive->clusterBitmapBase >= endCluster)
+        {
+            drive->clusterBitmapBase = 2;
+        }
+        drive->clusterBitmapValid = false;
+    }
+
+    return 0;
+}
+
+void FILEIO_ClusterBitmapUpdate (FILEIO_DRIVE * drive, uint32_t cluster, bool allocated)
+{
+    uint32_t mask;
+    uint16_t index;
+
+    if (!drive->clusterBitmapValid || (cluster < drive->clusterBitmapBase) || (cluster >= drive->clusterBitmapBase + FILEIO_CLUSTER_BITMAP_BITS))
+    {
+        return;
+    }
+
+    index = (uint16_t)((cluster - drive->clusterBitmapBase) >> 5);
+    mask = (uint32_t)1 << ((cluster - drive->clusterBitmapBase) & 0x1F);
+
+    if (allocated)
+    {
+        if ((drive->clusterBitmap[index] & mask) == 0)
+        {
+            drive->clusterBitmap[index] |= mask;
+            drive->clusterBitmapFree--;
+        }
+    }
+    else
+    {
+        if ((drive->clusterBitmap[index] & mask) != 0)
+        {
+            drive->clusterBitmap[index] &= ~mask;
+            drive->clusterBitmapFree++;
+        }
+    }
+}
+#endif
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+FILEIO_ERROR_TYPE FILEIO_EraseCluster (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint32_t sector = FILEIO_ClusterToSector (drive, cluster);
+
+    // The data cache buffers are used as the source of zeros, so write them back first
+    if (!FILEIO_FlushBuffer (drive, FILEIO_BUFFER_DATA) || !FILEIO_SectorsErase (drive, sector, drive->sectorsPerCluster))
+    {
+        error = FILEIO_ERROR_WRITE;
+    }
+
+    // As an optimization, cache the first sector of the cluster.  They're all zero anyway, now.
+    if ((error == FILEIO_ERROR_NONE) && (FILEIO_DataCacheSectorGet (drive, sector, false) != FILEIO_ERROR_NONE))
+    {
+        error = FILEIO_ERROR_WRITE;
+    }
+
+    drive->error = error;
+    return error;
+}
+#endif
+
+FILEIO_DIRECTORY_ENTRY * FILEIO_DirectoryEntryCache (FILEIO_DIRECTORY * directory, FILEIO_ERROR_TYPE * error, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset)
+{
+    FILEIO_DRIVE * disk = directory->drive;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    uint8_t directoryEntriesPerSector = disk->sectorSize / FILEIO_DIRECTORY_ENTRY_SIZE;
+    uint16_t totalSectorOffset = entryOffset / directoryEntriesPerSector;
+    uint32_t sector;
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    FILEIO_DIRECTORY_CHAIN_MAP * map = NULL;
+#endif
+
+    if ((disk->type != FILEIO_FILE_SYSTEM_TYPE_FAT32) && (*currentCluster == FILEIO_FIXED_ROOT_DIRECTORY_CLUSTER_NUMBER))
+    {
+        if (entryOffset >= disk->rootDirectoryEntryCount)
+        {
+            *error = FILEIO_ERROR_DONE;
+            return NULL;
+        }
+        // We're looking for the file in the FAT12/16 root directory
+        sector = FILEIO_ClusterToSector (directory->drive, directory->cluster);
+        sector += totalSectorOffset;
+    }
+    else
+    {
+        // Find the cluster/sector with the specified directory entry offset
+        uint16_t totalClusterOffset = totalSectorOffset / disk->sectorsPerCluster;
+        if (*currentClusterOffset > totalClusterOffset)
+        {
+            *currentClusterOffset = 0;
+            *currentCluster = directory->cluster;
+        }
+
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+        // Start from the closest cluster of the directory that is already known
+        if (*currentClusterOffset < totalClusterOffset)
+        {
+            map = FILEIO_DirectoryChainMapGet (directory);
+            FILEIO_DirectoryChainMapFind (map, totalClusterOffset, currentCluster, currentClusterOffset);
+        }
+#endif
+
+        totalSectorOffset -= (disk->sectorsPerCluster * (*currentClusterOffset));
+
+        while (*currentClusterOffset < totalClusterOffset)
+        {
+            *currentCluster = FILEIO_FATRead (disk, *currentCluster);
+            // Switch based on FAT type
+            switch (disk->type)
+            {
+                case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+                    if (*currentCluster == FILEIO_CLUSTER_VALUE_FAT32_EOF)
+                    {
+                        *error = FILEIO_ERROR_DONE;
+                        return NULL;
+                    }
+                    break;
+                case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+                case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+                default:
+                    if (*currentCluster == FILEIO_CLUSTER_VALUE_FAT16_EOF)
+                    {
+                        *error = FILEIO_ERROR_DONE;
+                        return NULL;
+                    }
+                    break;
+            }
+            *currentClusterOffset = *currentClusterOffset + 1;
+            totalSectorOffset -= disk->sectorsPerCluster;
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+            FILEIO_DirectoryChainMapAdd (map, *currentClusterOffset, *currentCluster);
+#endif
+        }
+
+        // currentCluster points to the cluster we need.  Convert to sectors and add the sector offset.
+        sector = FILEIO_ClusterToSector (disk, *currentCluster);
+        sector += totalSectorOffset;
+    }
+
+    if ((*error = FILEIO_DataCacheSectorGet (disk, sector, true)) != FILEIO_ERROR_NONE)
+    {
+        return NULL;
+    }
+
+    entry = (FILEIO_DIRECTORY_ENTRY *)((FILEIO_DIRECTORY_ENTRY *)disk->dataBuffer + (entryOffset % directoryEntriesPerSector));
+
+    *error = FILEIO_ERROR_NONE;
+    
+    return entry;
+}
+
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+// Returns the cluster chain map of a directory, replacing the least recently used map if the directory doesn't have one
+FILEIO_DIRECTORY_CHAIN_MAP * FILEIO_DirectoryChainMapGet (FILEIO_DIRECTORY * directory)
+{
+    FILEIO_DIRECTORY_CHAIN_MAP * map = gDirectoryChainMaps.maps;
+    uint32_t cluster = directory->cluster;
+    uint8_t i;
+
+    if (cluster == 0)
+    {
+        cluster = directory->drive->firstRootCluster;
+    }
+
+    for (i = 0; i < FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES; i++)
+    {
+        if ((gDirectoryChainMaps.maps[i].drive == directory->drive) && (gDirectoryChainMaps.maps[i].cluster == cluster))
+        {
+            gDirectoryChainMaps.maps[i].lastUse = ++gDirectoryChainMaps.useCount;
+            return gDirectoryChainMaps.maps + i;
+        }
+    }
+
+    for (i = 0; i < FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES; i++)
+    {
+        if (gDirectoryChainMaps.maps[i].drive == NULL)
+        {
+            map = gDirectoryChainMaps.maps + i;
+            break;
+        }
+        if (gDirectoryChainMaps.maps[i].lastUse < map->lastUse)
+        {
+            map = gDirectoryChainMaps.maps + i;
+        }
+    }
+
+    // Only the first cluster is known until the chain is followed
+    map->drive = directory->drive;
+    map->cluster = cluster;
+    map->lastUse = ++gDirectoryChainMaps.useCount;
+    map->length = 1;
+    map->runCount = 1;
+    map->runs[0].cluster = cluster;
+    map->runs[0].offset = 0;
+
+    return map;
+}
+
+// Moves a position in a directory's chain to the known cluster closest to clusterOffset, if that is closer than the
+// current position
+void FILEIO_DirectoryChainMapFind (FILEIO_DIRECTORY_CHAIN_MAP * map, uint16_t clusterOffset, uint32_t * currentCluster, uint16_t * currentClusterOffset)
+{
+    FILEIO_DIRECTORY_CHAIN_RUN * run;
+    uint8_t low = 0;
+    uint8_t high = map->runCount;
+    uint8_t middle;
+
+    if (clusterOffset >= map->length)
+    {
+        clusterOffset = map->length - 1;
+    }
+
+    if (clusterOffset <= *currentClusterOffset)
+    {
+        return;
+    }
+
+    // Find the last run that starts at or before the cluster
+    while (low < high)
+    {
+        middle = (low + high) >> 1;
+        if (map->runs[middle].offset <= clusterOffset)
+        {
+            low = middle + 1;
         }
         else
         {
-            disk->bufferStatusPtr->dataBufferCachedSector = sector;
-#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-            disk->bufferStatusPtr->driveOwner = disk;
+            high = middle;
+        }
+    }
+
+    run = map->runs + low - 1;
+    *currentCluster = run->cluster + (clusterOffset - run->offset);
+    *currentClusterOffset = clusterOffset;
+}
+
+// Records the next cluster of a directory's chain.  Clusters that don't directly follow the known part of the chain
+// are ignored.
+void FILEIO_DirectoryChainMapAdd (FILEIO_DIRECTORY_CHAIN_MAP * map, uint16_t clusterOffset, uint32_t cluster)
+{
+    FILEIO_DIRECTORY_CHAIN_RUN * run = map->runs + map->runCount - 1;
+
+    if ((clusterOffset != map->length) || (cluster < 2) || (cluster >= map->drive->partitionClusterCount + 2))
+    {
+        return;
+    }
+
+    if (cluster != run->cluster + (clusterOffset - run->offset))
+    {
+        if (map->runCount == FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+        {
+            return;
+        }
+        run++;
+        run->cluster = cluster;
+        run->offset = clusterOffset;
+        map->runCount++;
+    }
+
+    map->length++;
+}
+
+// Forgets the chain of a directory that was removed
+void FILEIO_DirectoryChainMapDrop (FILEIO_DRIVE * drive, uint32_t cluster)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES; i++)
+    {
+        if ((gDirectoryChainMaps.maps[i].drive == drive) && (gDirectoryChainMaps.maps[i].cluster == cluster))
+        {
+            gDirectoryChainMaps.maps[i].drive = NULL;
+        }
+    }
+}
+
+void FILEIO_DirectoryChainMapDriveDrop (FILEIO_DRIVE * drive)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES; i++)
+    {
+        if (gDirectoryChainMaps.maps[i].drive == drive)
+        {
+            gDirectoryChainMaps.maps[i].drive = NULL;
+        }
+    }
+}
+#endif
+
+FILEIO_ERROR_TYPE FILEIO_ForceRecache (FILEIO_DRIVE * disk)
+{
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_DATA))
+    {
+        return FILEIO_ERROR_WRITE;
+    }
 #endif
+    if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, disk->bufferStatusPtr->dataBufferCachedSector, disk->dataBuffer) != true)
+    {
+        return FILEIO_ERROR_BAD_SECTOR_READ;
+    }
+
+    return FILEIO_ERROR_NONE;
+}
+
+void FILEIO_DataCacheInitialize (FILEIO_BUFFER_STATUS * bufferStatusPtr, uint8_t * buffer)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+    {
+        bufferStatusPtr->dataCache[i].buffer = buffer + ((uint16_t)i * FILEIO_CONFIG_MEDIA_SECTOR_SIZE);
+        bufferStatusPtr->dataCache[i].age = i;
+    }
+
+    bufferStatusPtr->dataCacheActive = 0;
+
+    FILEIO_DataCacheInvalidate (bufferStatusPtr);
+}
+
+void FILEIO_DataCacheInvalidate (FILEIO_BUFFER_STATUS * bufferStatusPtr)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+    {
+        bufferStatusPtr->dataCache[i].sector = 0xFFFFFFFF;
+        bufferStatusPtr->dataCache[i].needsWrite = false;
+    }
+
+    bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
+    bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+}
+
+// Drops any cached copies of the sectors in the specified range without writing them back.
+// Used when those sectors are written to the media directly.
+void FILEIO_DataCacheDiscard (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count)
+{
+    FILEIO_BUFFER_STATUS * bufferStatusPtr = disk->bufferStatusPtr;
+    uint8_t i;
+
+    if ((bufferStatusPtr->dataBufferCachedSector >= sector) && (bufferStatusPtr->dataBufferCachedSector < (sector + count)))
+    {
+        bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
+        bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+    }
+
+    for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+    {
+        if ((i != bufferStatusPtr->dataCacheActive) && (bufferStatusPtr->dataCache[i].sector >= sector) && (bufferStatusPtr->dataCache[i].sector < (sector + count)))
+        {
+            bufferStatusPtr->dataCache[i].sector = 0xFFFFFFFF;
+            bufferStatusPtr->dataCache[i].needsWrite = false;
+        }
+    }
+}
+
+// Reads a range of sectors into a caller-supplied buffer without changing the contents of the data cache.
+// Sectors that are cached are copied from the cache, since they may hold data that hasn't been written yet.
+FILEIO_ERROR_TYPE FILEIO_DataSectorsRead (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer)
+{
+    FILEIO_BUFFER_STATUS * bufferStatusPtr = disk->bufferStatusPtr;
+    uint8_t * cachedSector;
+    uint32_t run = 0;
+    uint8_t i;
+
+    for ( ; count != 0; count--, sector++, buffer += disk->sectorSize)
+    {
+        cachedSector = NULL;
+        if (bufferStatusPtr->dataBufferCachedSector == sector)
+        {
+            cachedSector = disk->dataBuffer;
+        }
+        else
+        {
+            for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+            {
+                if ((i != bufferStatusPtr->dataCacheActive) && (bufferStatusPtr->dataCache[i].sector == sector))
+                {
+                    cachedSector = bufferStatusPtr->dataCache[i].buffer;
+                    break;
+                }
+            }
+        }
+
+        if (cachedSector == NULL)
+        {
+            // Collect consecutive uncached sectors into a single transfer
+            run++;
+            continue;
+        }
+
+        if ((run != 0) && !FILEIO_SectorsRead (disk, sector - run, run, buffer - (run * disk->sectorSize)))
+        {
+            return FILEIO_ERROR_BAD_SECTOR_READ;
         }
+        run = 0;
+
+        memcpy (buffer, cachedSector, disk->sectorSize);
     }
 
-    entry = (FILEIO_DIRECTORY_ENTRY *)((FILEIO_DIRECTORY_ENTRY *)disk->dataBuffer + (entryOffset % directoryEntriesPerSector));
+    if ((run != 0) && !FILEIO_SectorsRead (disk, sector - run, run, buffer - (run * disk->sectorSize)))
+    {
+        return FILEIO_ERROR_BAD_SECTOR_READ;
+    }
 
-    *error = FILEIO_ERROR_NONE;
-    
-    return entry;
+    return FILEIO_ERROR_NONE;
 }
 
-FILEIO_ERROR_TYPE FILEIO_ForceRecache (FILEIO_DRIVE * disk)
+// Reads a run of consecutive sectors from the media.  Drivers that don't provide a multi-sector read
+// function are called once per sector.
+bool FILEIO_SectorsRead (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer)
 {
+    if (disk->driveConfig->funcSectorReadMulti != NULL)
+    {
+        return (*disk->driveConfig->funcSectorReadMulti) (disk->mediaParameters, sector, count, buffer);
+    }
+
+    for ( ; count != 0; count--, sector++, buffer += disk->sectorSize)
+    {
+        if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector, buffer) != true)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-    if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_DATA))
+// Writes zeros to a run of consecutive sectors.  Every data cache buffer is used as the source so that each
+// transfer covers as many sectors as possible; the cache is invalidated, so any dirty sectors in it must be
+// written back first.
+bool FILEIO_SectorsErase (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count)
+{
+    uint8_t * zeroBuffer = disk->bufferStatusPtr->dataCache[0].buffer;
+    uint32_t run;
+
+    FILEIO_DataCacheInvalidate (disk->bufferStatusPtr);
+    memset (zeroBuffer, 0x00, (size_t)FILEIO_CONFIG_DATA_CACHE_SECTORS * FILEIO_CONFIG_MEDIA_SECTOR_SIZE);
+
+    for ( ; count != 0; count -= run, sector += run)
     {
-        return FILEIO_ERROR_WRITE;
+        run = (count < FILEIO_CONFIG_DATA_CACHE_SECTORS) ? count : FILEIO_CONFIG_DATA_CACHE_SECTORS;
+        if (!FILEIO_SectorsWrite (disk, sector, run, zeroBuffer))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Writes a run of consecutive sectors to the media.  Drivers that don't provide a multi-sector write
+// function are called once per sector.
+bool FILEIO_SectorsWrite (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer)
+{
+    if (disk->driveConfig->funcSectorWriteMulti != NULL)
+    {
+        return (*disk->driveConfig->funcSectorWriteMulti) (disk->mediaParameters, sector, count, buffer);
+    }
+
+    for ( ; count != 0; count--, sector++, buffer += disk->sectorSize)
+    {
+        if (!(*disk->driveConfig->funcSectorWrite) (disk->mediaParameters, sector, buffer, false))
+        {
+            return false;
+        }
     }
+
+    return true;
+}
 #endif
-    if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, disk->bufferStatusPtr->dataBufferCachedSector, disk->dataBuffer) != true)
+
+// Makes the specified sector the active data cache entry.  If the sector isn't cached, the least recently
+// used entry is written back (if necessary) and reused.  If readSector is false the contents of a newly
+// assigned entry are undefined; the caller must overwrite the entire sector.
+FILEIO_ERROR_TYPE FILEIO_DataCacheSectorGet (FILEIO_DRIVE * disk, uint32_t sector, bool readSector)
+{
+    FILEIO_BUFFER_STATUS * bufferStatusPtr = disk->bufferStatusPtr;
+    FILEIO_DATA_CACHE_ENTRY * cacheEntry;
+    uint8_t index = 0;
+    uint8_t i;
+
+    if (bufferStatusPtr->dataBufferCachedSector == sector)
     {
-        return FILEIO_ERROR_BAD_SECTOR_READ;
+        return FILEIO_ERROR_NONE;
+    }
+
+    // Save the state of the active entry
+    cacheEntry = &bufferStatusPtr->dataCache[bufferStatusPtr->dataCacheActive];
+    cacheEntry->sector = bufferStatusPtr->dataBufferCachedSector;
+    cacheEntry->needsWrite = bufferStatusPtr->flags.dataBufferNeedsWrite;
+
+    // Look for the sector, keeping track of the least recently used entry in case it isn't cached
+    for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+    {
+        if (bufferStatusPtr->dataCache[i].sector == sector)
+        {
+            index = i;
+            break;
+        }
+        if (bufferStatusPtr->dataCache[i].age > bufferStatusPtr->dataCache[index].age)
+        {
+            index = i;
+        }
+    }
+
+    cacheEntry = &bufferStatusPtr->dataCache[index];
+
+    if (i == FILEIO_CONFIG_DATA_CACHE_SECTORS)
+    {
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+        if (cacheEntry->needsWrite)
+        {
+            if (!(*disk->driveConfig->funcSectorWrite)(disk->mediaParameters, cacheEntry->sector, cacheEntry->buffer, false))
+            {
+                return FILEIO_ERROR_WRITE;
+            }
+            cacheEntry->needsWrite = false;
+        }
+#endif
+        cacheEntry->sector = 0xFFFFFFFF;
+
+        if (readSector && ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector, cacheEntry->buffer) != true))
+        {
+            if (index == bufferStatusPtr->dataCacheActive)
+            {
+                bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
+                bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+            }
+            return FILEIO_ERROR_BAD_SECTOR_READ;
+        }
+
+        cacheEntry->sector = sector;
+    }
+
+    // Move the entry to the front of the LRU order
+    for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++)
+    {
+        if (bufferStatusPtr->dataCache[i].age < cacheEntry->age)
+        {
+            bufferStatusPtr->dataCache[i].age++;
+        }
     }
+    cacheEntry->age = 0;
+
+    bufferStatusPtr->dataCacheActive = index;
+    bufferStatusPtr->dataBufferCachedSector = sector;
+    bufferStatusPtr->flags.dataBufferNeedsWrite = cacheEntry->needsWrite;
+    disk->dataBuffer = cacheEntry->buffer;
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    bufferStatusPtr->driveOwner = disk;
+#endif
 
     return FILEIO_ERROR_NONE;
 }
 
+void FILEIO_FATCacheInvalidate (FILEIO_BUFFER_STATUS * bufferStatusPtr)
+{
+    uint8_t i;
+
+    for (i = 0; i < FILEIO_CONFIG_FAT_CACHE_SECTORS; i++)
+    {
+        bufferStatusPtr->fatCacheSector[i] = 0xFFFFFFFF;
+        bufferStatusPtr->fatCacheAge[i] = i % FILEIO_CONFIG_FAT_CACHE_WAYS;
+    }
+
+    memset (bufferStatusPtr->fatCacheDirty, 0x00, sizeof (bufferStatusPtr->fatCacheDirty));
+}
+
+// Returns a pointer to the cached copy of the specified FAT sector.  If the sector isn't cached, the least
+// recently used entry in its set is written back (if necessary) and reloaded.  Returns NULL on failure.
+uint8_t * FILEIO_FATCacheSectorGet (FILEIO_DRIVE * disk, uint32_t sector, bool markDirty)
+{
+    FILEIO_BUFFER_STATUS * bufferStatusPtr = disk->bufferStatusPtr;
+    uint8_t first = (uint8_t)(sector % FILEIO_FAT_CACHE_SETS) * FILEIO_CONFIG_FAT_CACHE_WAYS;
+    uint8_t index = first;
+    uint8_t i;
+
+    for (i = first; i < (first + FILEIO_CONFIG_FAT_CACHE_WAYS); i++)
+    {
+        if (bufferStatusPtr->fatCacheSector[i] == sector)
+        {
+            index = i;
+            break;
+        }
+        if (bufferStatusPtr->fatCacheAge[i] > bufferStatusPtr->fatCacheAge[index])
+        {
+            index = i;
+        }
+    }
+
+    if (i == (first + FILEIO_CONFIG_FAT_CACHE_WAYS))
+    {
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+        if (!FILEIO_FATCacheEntryWrite (disk, index))
+        {
+            return NULL;
+        }
+#endif
+        if (!(*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector, disk->fatBuffer + ((uint16_t)index * FILEIO_CONFIG_MEDIA_SECTOR_SIZE)))
+        {
+            bufferStatusPtr->fatCacheSector[index] = 0xFFFFFFFF;  // Note: It is Sector not Cluster.
+            return NULL;
+        }
+        bufferStatusPtr->fatCacheSector[index] = sector;
+    }
+
+    // Move the entry to the front of the LRU order of its set
+    for (i = first; i < (first + FILEIO_CONFIG_FAT_CACHE_WAYS); i++)
+    {
+        if (bufferStatusPtr->fatCacheAge[i] < bufferStatusPtr->fatCacheAge[index])
+        {
+            bufferStatusPtr->fatCacheAge[i]++;
+        }
+    }
+    bufferStatusPtr->fatCacheAge[index] = 0;
+
+    if (markDirty)
+    {
+        bufferStatusPtr->fatCacheDirty[index >> 3] |= (1 << (index & 0x07));
+    }
+
+    return disk->fatBuffer + ((uint16_t)index * FILEIO_CONFIG_MEDIA_SECTOR_SIZE);
+}
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+// Writes a FAT cache entry to every copy of the FAT if it has been modified.  In deferred mirroring mode, only the
+// first copy is written and the sector is recorded for FILEIO_FATMirrorSync.
+bool FILEIO_FATCacheEntryWrite (FILEIO_DRIVE * disk, uint8_t index)
+{
+    FILEIO_BUFFER_STATUS * bufferStatusPtr = disk->bufferStatusPtr;
+    uint32_t sector = bufferStatusPtr->fatCacheSector[index];
+    uint8_t copies = disk->fatCopyCount;
+    uint8_t i;
+
+    if ((bufferStatusPtr->fatCacheDirty[index >> 3] & (1 << (index & 0x07))) == 0)
+    {
+        return true;
+    }
+
+    if ((disk->fatMirroring == FILEIO_FAT_MIRRORING_DEFERRED) && (copies > 1))
+    {
+        FILEIO_FATMirrorMark (disk, sector);
+        copies = 1;
+    }
+
+    for (i = 0; i < copies; i++, sector += disk->fatSectorCount)
+    {
+        if (! (*disk->driveConfig->funcSectorWrite)(disk->mediaParameters, sector, disk->fatBuffer + ((uint16_t)index * FILEIO_CONFIG_MEDIA_SECTOR_SIZE), false) )
+        {
+            return false;
+        }
+    }
+
+    bufferStatusPtr->fatCacheDirty[index >> 3] &= ~(1 << (index & 0x07));
+
+    return true;
+}
+
+// Records that a sector of the first FAT copy differs from the other copies.  The ranges are kept sorted and disjoint;
+// when all of them are in use, the closest one is extended to cover the sector.
+void FILEIO_FATMirrorMark (FILEIO_DRIVE * disk, uint32_t sector)
+{
+    uint8_t count = disk->fatMirrorRangeCount;
+    uint8_t i;
+
+    // Find the first range that contains the sector, follows it or ends just before it
+    for (i = 0; (i < count) && (disk->fatMirrorRanges[i].end < sector); i++);
+
+    if ((i < count) && (disk->fatMirrorRanges[i].start <= (sector + 1)))
+    {
+        if (sector < disk->fatMirrorRanges[i].start)
+        {
+            disk->fatMirrorRanges[i].start = sector;
+        }
+        else if (sector == disk->fatMirrorRanges[i].end)
+        {
+            disk->fatMirrorRanges[i].end++;
+            // Merge with the next range if the gap between them has closed
+            if (((i + 1) < count) && (disk->fatMirrorRanges[i + 1].start == disk->fatMirrorRanges[i].end))
+            {
+                disk->fatMirrorRanges[i].end = disk->fatMirrorRanges[i + 1].end;
+                for (i++; (i + 1) < count; i++)
+                {
+                    disk->fatMirrorRanges[i] = disk->fatMirrorRanges[i + 1];
+                }
+                disk->fatMirrorRangeCount--;
+            }
+        }
+    }
+    else if (count == FILEIO_FAT_MIRROR_RANGE_COUNT)
+    {
+        if ((i == count) || ((i != 0) && ((sector - disk->fatMirrorRanges[i - 1].end) < (disk->fatMirrorRanges[i].start - sector))))
+        {
+            disk->fatMirrorRanges[i - 1].end = sector + 1;
+        }
+        else
+        {
+            disk->fatMirrorRanges[i].start = sector;
+        }
+    }
+    else
+    {
+        for ( ; count > i; count--)
+        {
+            disk->fatMirrorRanges[count] = disk->fatMirrorRanges[count - 1];
+        }
+        disk->fatMirrorRanges[i].start = sector;
+        disk->fatMirrorRanges[i].end = sector + 1;
+        disk->fatMirrorRangeCount++;
+    }
+}
+
+// Writes back the first FAT copy, then copies the sectors recorded by FILEIO_FATMirrorMark to the other copies in
+// ascending order
+bool FILEIO_FATMirrorSync (FILEIO_DRIVE * disk)
+{
+    uint8_t * buffer;
+    uint32_t sector;
+    uint8_t range;
+    uint8_t i;
+
+    if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
+    {
+        return false;
+    }
+
+    for (range = 0; range < disk->fatMirrorRangeCount; range++)
+    {
+        for (sector = disk->fatMirrorRanges[range].start; sector < disk->fatMirrorRanges[range].end; sector++)
+        {
+            if ((buffer = FILEIO_FATCacheSectorGet (disk, sector, false)) == NULL)
+            {
+                return false;
+            }
+
+            for (i = 1; i < disk->fatCopyCount; i++)
+            {
+                if (!(*disk->driveConfig->funcSectorWrite)(disk->mediaParameters, sector + (i * disk->fatSectorCount), buffer, false))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    disk->fatMirrorRangeCount = 0;
+
+    return true;
+}
+#endif
+
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
 bool FILEIO_FlushBuffer (FILEIO_DRIVE * disk, FILEIO_BUFFER_ID bufferId)
 {
@@ -2292,20 +4602,37 @@ bool FILEIO_FlushBuffer (FILEIO_DRIVE * disk, FILEIO_BUFFER_ID bufferId)
                 }
                 disk->bufferStatusPtr->flags.dataBufferNeedsWrite = false;
             }
+#if (FILEIO_CONFIG_DATA_CACHE_SECTORS > 1)
+            {
+                FILEIO_DATA_CACHE_ENTRY * cacheEntry = disk->bufferStatusPtr->dataCache;
+                uint8_t i;
+
+                // Write back the inactive entries
+                for (i = 0; i < FILEIO_CONFIG_DATA_CACHE_SECTORS; i++, cacheEntry++)
+                {
+                    if ((i != disk->bufferStatusPtr->dataCacheActive) && cacheEntry->needsWrite)
+                    {
+                        if (!(*disk->driveConfig->funcSectorWrite)(disk->mediaParameters, cacheEntry->sector, cacheEntry->buffer, false) )
+                        {
+                            return false;
+                        }
+                        cacheEntry->needsWrite = false;
+                    }
+                }
+            }
+#endif
             break;
         case FILEIO_BUFFER_FAT:
-            if (disk->bufferStatusPtr->flags.fatBufferNeedsWrite)
             {
-                uint32_t sector = disk->bufferStatusPtr->fatBufferCachedSector;
                 uint8_t i;
-                for (i = 0; i < disk->fatCopyCount; i++, sector += disk->fatSectorCount)
+
+                for (i = 0; i < FILEIO_CONFIG_FAT_CACHE_SECTORS; i++)
                 {
-                    if (! (*disk->driveConfig->funcSectorWrite)(disk->mediaParameters, sector, disk->fatBuffer, false) )
+                    if (!FILEIO_FATCacheEntryWrite (disk, i))
                     {
                         return false;
                     }
                 }
-                disk->bufferStatusPtr->flags.fatBufferNeedsWrite = false;
             }
             break;
     }
@@ -2388,6 +4715,7 @@ uint32_t FILEIO_ClusterToSector(FILEIO_DRIVE * disk, uint32_t cluster)
 uint32_t FILEIO_FATRead (FILEIO_DRIVE * disk, uint32_t currentCluster)
 {
     uint8_t q;
+    uint8_t * fatSector;
     uint32_t p, sector_address;
     uint32_t c = 0, d, ClusterFailValue,LastClusterLimit;   // ClusterEntries
 
@@ -2419,107 +4747,46 @@ uint32_t FILEIO_FATRead (FILEIO_DRIVE * disk, uint32_t currentCluster)
     sector_address = disk->firstFatSector + (p >> ((disk->sectorSize >> 9) + 8));     //p/(disk->sectorSize) = p>>((disk->sectorSize >> 9)+8)
     p &= disk->sectorSize - 1;                 // Restrict 'p' within the FATbuffer size
 
-    // Check if the appropriate FAT sector is already loaded
-    if (disk->bufferStatusPtr->fatBufferCachedSector == sector_address)
+    // Load the appropriate FAT sector, if it isn't already cached
+    if ((fatSector = FILEIO_FATCacheSectorGet (disk, sector_address, false)) == NULL)
+    {
+        return ClusterFailValue;
+    }
+
+    if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+    {
+        memcpy(&c, &fatSector[p], 4);
+    }
+    else
     {
-        if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+        if(disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT16)
         {
-            memcpy(&c, &disk->fatBuffer[p], 4);
+            memcpy(&c, &fatSector[p], 2 );
         }
-        else
+        else if(disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT12)
         {
-            if(disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT16)
+            c = *(fatSector + p);
+            if (q)
             {
-                memcpy(&c, &disk->fatBuffer[p], 2 );
+                c >>= 4;
             }
-            else if(disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT12)
+            // Check if the MSB is across the sector boundary
+            p = (p +1) & (disk->sectorSize-1);
+            if (p == 0)
             {
-                c = *(disk->fatBuffer + p);
-                if (q)
-                {
-                    c >>= 4;
-                }
-                // Check if the MSB is across the sector boundary
-                p = (p +1) & (disk->sectorSize-1);
-                if (p == 0)
-                {
-                    // Start by writing the sector we just worked on to the card
-                    // if we need to
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-                    if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
-                    {
-                        return ClusterFailValue;
-                    }
-#endif
-                    if (!(*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector_address+1, disk->fatBuffer))
-                    {
-                        disk->bufferStatusPtr->fatBufferCachedSector = 0xFFFFFFFF;
-                        return ClusterFailValue;
-                    }
-                    else
-                    {
-                        disk->bufferStatusPtr->fatBufferCachedSector = sector_address + 1;
-                    }
-                }
-                d = *(disk->fatBuffer + p);
-                if (q)
-                {
-                    c += (d <<4);
-                }
-                else
+                if ((fatSector = FILEIO_FATCacheSectorGet (disk, sector_address + 1, false)) == NULL)
                 {
-                    c += ((d & 0x0F)<<8);
+                    return ClusterFailValue;
                 }
-            }
-        }
-    }
-    else
-    {
-        // If there's a currently open FAT sector,
-        // write it back before reading into the buffer
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-        if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
-        {
-            return ClusterFailValue;
-        }
-#endif
-        if (!(*disk->driveConfig->funcSectorRead) (disk->mediaParameters, sector_address, disk->fatBuffer))
-        {
-            disk->bufferStatusPtr->fatBufferCachedSector = 0xFFFFFFFF;  // Note: It is Sector not Cluster.
-            return ClusterFailValue;
-        }
-        else
-        {
-            disk->bufferStatusPtr->fatBufferCachedSector = sector_address;
-
-            if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)
+            }
+            d = *(fatSector + p);
+            if (q)
             {
-                memcpy(&c, &disk->fatBuffer[p], 4);
+                c += (d <<4);
             }
             else
             {
-                if(disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT16)
-                {
-                    memcpy(&c, &disk->fatBuffer[p], 2);
-                }
-                else if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT12)
-                {
-                    c = *(disk->fatBuffer + p);
-                    if (q)
-                    {
-                        c >>= 4;
-                    }
-                    p = (p +1) & (disk->sectorSize-1);
-                    d = *(disk->fatBuffer + p);
-                    if (q)
-                    {
-                        c += (d <<4);
-                    }
-                    else
-                    {
-                        c += ((d & 0x0F)<<8);
-                    }
-                }
+                c += ((d & 0x0F)<<8);
             }
         }
     }
@@ -2543,6 +4810,9 @@ FILEIO_ERROR_TYPE FILEIO_EraseFile (FILEIO_OBJECT * filePtr, uint16_t * entryHan
     uint32_t currentCluster;
     uint16_t currentClusterOffset;
     uint16_t tempEntryHandle = *entryHandle;
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+    uint16_t firstErased = *entryHandle;
+#endif
     uint8_t sequenceNumber;
 
     error = FILEIO_ERROR_ERASE_FAIL;
@@ -2577,6 +4847,9 @@ FILEIO_ERROR_TYPE FILEIO_EraseFile (FILEIO_OBJECT * filePtr, uint16_t * entryHan
         else
         {
             entry->name[0] = FILEIO_DIRECTORY_ENTRY_DELETED;
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+            firstErased = tempEntryHandle;
+#endif
             // Mark the cached sector as needing a write.
             disk->bufferStatusPtr->flags.dataBufferNeedsWrite = true;
         }
@@ -2592,6 +4865,41 @@ FILEIO_ERROR_TYPE FILEIO_EraseFile (FILEIO_OBJECT * filePtr, uint16_t * entryHan
         entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, tempEntryHandle);
     } while (entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME);
 
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    FILEIO_DirectoryIndexRemove (disk, filePtr->baseClusterDir, *entryHandle);
+    if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+    {
+        // The directory's clusters may be reused
+        FILEIO_DirectoryIndexDrop (disk, filePtr->firstCluster);
+    }
+#endif
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+    {
+        FILEIO_PathCacheDrop (disk, filePtr->firstCluster);
+    }
+#endif
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+    {
+        // The directory may be in the current working directory's path
+        globalParameters.workingDirectoryPathLength = 0;
+    }
+#endif
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+    FILEIO_FreeEntryHintRelease (disk, filePtr->baseClusterDir, firstErased, *entryHandle - firstErased + 1);
+    if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+    {
+        FILEIO_FreeEntryHintDrop (disk, filePtr->firstCluster);
+    }
+#endif
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+    {
+        FILEIO_DirectoryChainMapDrop (disk, filePtr->firstCluster);
+    }
+#endif
+
     if (error == FILEIO_ERROR_NONE)
     {
         // Check to make sure someone isn't trying to erase the root directory.  This should never happen.
@@ -2624,8 +4932,27 @@ FILEIO_ERROR_TYPE FILEIO_EraseFile (FILEIO_OBJECT * filePtr, uint16_t * entryHan
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
 FILEIO_ERROR_TYPE FILEIO_EraseClusterChain (uint32_t cluster, FILEIO_DRIVE * disk)
 {
+    uint32_t count = 0xFFFFFFFF;
+    FILEIO_ERROR_TYPE error;
+
+    error = FILEIO_ClusterChainFree (disk, &cluster, &count);
+
+    FILEIO_FATWrite (disk, 0, 0, true);
+
+    return error;
+}
+
+// Frees up to *count clusters of the chain that starts at *cluster and returns the number freed in *count.  The chain is
+// walked FILEIO_FAT_FREE_BATCH_SIZE clusters at a time and each batch is freed in cluster order, so a fragmented chain
+// changes each FAT sector once per batch instead of once per visit.  Returns FILEIO_ERROR_DONE once the end of the
+// chain has been freed, or FILEIO_ERROR_NONE with the first cluster still to be freed in *cluster.
+FILEIO_ERROR_TYPE FILEIO_ClusterChainFree (FILEIO_DRIVE * disk, uint32_t * cluster, uint32_t * count)
+{
+    FILEIO_FAT_UPDATE updates[FILEIO_FAT_FREE_BATCH_SIZE];
     uint32_t nextCluster, clusterFailed, clusterFinal;
+    uint32_t limit = *count;
     FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint16_t batch;
 
     switch (disk->type)
     {
@@ -2644,54 +4971,178 @@ FILEIO_ERROR_TYPE FILEIO_EraseClusterChain (uint32_t cluster, FILEIO_DRIVE * dis
             break;
     }
 
-    if ((cluster == 0) || (cluster == 1))
+    *count = 0;
+
+    if ((*cluster == 0) || (*cluster == 1))
     {
-        error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_ERROR_INVALID_ARGUMENT;
     }
-    else
+
+    while ((error == FILEIO_ERROR_NONE) && (*count < limit))
     {
-        while (error == FILEIO_ERROR_NONE)
+        // Record the next part of the chain
+        batch = 0;
+        while ((error == FILEIO_ERROR_NONE) && (batch < FILEIO_FAT_FREE_BATCH_SIZE) && ((*count + batch) < limit))
         {
-            if ((nextCluster = FILEIO_FATRead (disk, cluster)) == clusterFailed)
+            if ((nextCluster = FILEIO_FATRead (disk, *cluster)) == clusterFailed)
             {
                 error = FILEIO_ERROR_DONE;
             }
+            else if ((nextCluster == 0) || (nextCluster == 1))
+            {
+                error = FILEIO_ERROR_INVALID_ARGUMENT;
+            }
             else
             {
-                if ((nextCluster == 0) || (nextCluster == 1))
+                if (nextCluster >= clusterFinal)
                 {
-                    error = FILEIO_ERROR_INVALID_ARGUMENT;
+                    error = FILEIO_ERROR_DONE;
                 }
-                else
-                {
-                    if (nextCluster >= clusterFinal)
-                    {
-                        error = FILEIO_ERROR_DONE;
-                    }
 
-                    if (FILEIO_FATWrite (disk, cluster, FILEIO_CLUSTER_VALUE_EMPTY, false) == clusterFailed)
-                    {
-                        error = FILEIO_ERROR_WRITE;
-                    }
+                updates[batch].cluster = *cluster;
+                updates[batch].value = FILEIO_CLUSTER_VALUE_EMPTY;
+                batch++;
 
-                    cluster = nextCluster;
-                }
+                *cluster = nextCluster;
             }
         }
-    }
 
-    FILEIO_FATWrite (disk, 0, 0, true);
+        if (FILEIO_FATWriteBatch (disk, updates, batch) != FILEIO_ERROR_NONE)
+        {
+            return FILEIO_ERROR_WRITE;
+        }
+
+        *count += batch;
+    }
 
     return error;
 }
 #endif
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+// Returns the sector of the FAT, relative to the start of the FAT, that holds the cluster's entry
+uint32_t FILEIO_FATSectorGet (FILEIO_DRIVE * disk, uint32_t cluster)
+{
+    switch (disk->type)
+    {
+        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+            return (cluster * 4) / disk->sectorSize;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+            return (cluster + (cluster >> 1)) / disk->sectorSize;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+        default:
+            return (cluster * 2) / disk->sectorSize;
+    }
+}
+
+// Applies a batch of changes to the FAT in order of cluster number, so each FAT sector is loaded and changed once
+FILEIO_ERROR_TYPE FILEIO_FATWriteBatch (FILEIO_DRIVE * disk, FILEIO_FAT_UPDATE * updates, uint16_t count)
+{
+    FILEIO_FAT_UPDATE update;
+    uint32_t clusterFailValue;
+    uint16_t i, j;
+
+    clusterFailValue = (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT32) ? FILEIO_CLUSTER_VALUE_FAT32_FAIL : FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+
+    // Batches are small, so an insertion sort is enough
+    for (i = 1; i < count; i++)
+    {
+        update = updates[i];
+        for (j = i; (j > 0) && (updates[j - 1].cluster > update.cluster); j--)
+        {
+            updates[j] = updates[j - 1];
+        }
+        updates[j] = update;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (FILEIO_FATWrite (disk, updates[i].cluster, updates[i].value, false) == clusterFailValue)
+        {
+            return FILEIO_ERROR_WRITE;
+        }
+    }
+
+    return FILEIO_ERROR_NONE;
+}
+
+// Chains up to FILEIO_FAT_CHAIN_BATCH_SIZE clusters in the order given, marks the last one as the end of the chain and
+// links the first one to previousCluster (unless it is 0).  The FAT sector holding previousCluster's entry is changed
+// last, so the new clusters are terminated before they become part of the chain.
+FILEIO_ERROR_TYPE FILEIO_FATChainExtend (FILEIO_DRIVE * disk, uint32_t previousCluster, const uint32_t * clusters, uint16_t count)
+{
+    FILEIO_FAT_UPDATE updates[FILEIO_FAT_CHAIN_BATCH_SIZE + 1];
+    FILEIO_FAT_UPDATE update;
+    FILEIO_ERROR_TYPE error;
+    uint32_t eofValue, linkSector;
+    uint16_t i, later;
+
+    if ((count == 0) || (count > FILEIO_FAT_CHAIN_BATCH_SIZE))
+    {
+        return FILEIO_ERROR_INVALID_ARGUMENT;
+    }
+
+    switch (disk->type)
+    {
+        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT12_EOF;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT32_EOF;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+        default:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT16_EOF;
+            break;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        updates[i].cluster = clusters[i];
+        updates[i].value = (i == count - 1) ? eofValue : clusters[i + 1];
+    }
+
+    if (previousCluster == 0)
+    {
+        return FILEIO_FATWriteBatch (disk, updates, count);
+    }
+
+    updates[count].cluster = previousCluster;
+    updates[count].value = clusters[0];
+    count++;
+
+    // Move the changes in the link's sector to the end of the batch and apply them separately
+    linkSector = FILEIO_FATSectorGet (disk, previousCluster);
+    later = count;
+    for (i = 0; i < later; )
+    {
+        if (FILEIO_FATSectorGet (disk, updates[i].cluster) == linkSector)
+        {
+            later--;
+            update = updates[i];
+            updates[i] = updates[later];
+            updates[later] = update;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if ((error = FILEIO_FATWriteBatch (disk, updates, later)) != FILEIO_ERROR_NONE)
+    {
+        return error;
+    }
+
+    return FILEIO_FATWriteBatch (disk, updates + later, count - later);
+}
+
 uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t value, uint8_t forceWrite)
 {
     uint8_t q, c;
+    uint8_t * fatSector;
     uint32_t p, l, clusterFailValue;
-    FILEIO_BUFFER_STATUS * statusPtr = disk->bufferStatusPtr;
+    uint32_t oldValue = FILEIO_CLUSTER_VALUE_EMPTY;
 
     if ((disk->type != FILEIO_FILE_SYSTEM_TYPE_FAT32) && (disk->type != FILEIO_FILE_SYSTEM_TYPE_FAT16) && (disk->type != FILEIO_FILE_SYSTEM_TYPE_FAT12))
     {
@@ -2719,6 +5170,28 @@ uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t
         return 0;
     }
 
+    // Mark the volume as in use before the first change to the FAT
+    if (disk->volumeState == FILEIO_VOLUME_STATE_CLEAN)
+    {
+        if (!FILEIO_VolumeStateSet (disk, FILEIO_VOLUME_STATE_IN_USE))
+        {
+            return clusterFailValue;
+        }
+    }
+
+    // Get the old value of the entry to keep the free cluster count and the free extent index current
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    if ((disk->freeClusterCount != FILEIO_FREE_CLUSTER_COUNT_UNKNOWN) || disk->freeExtentsValid)
+#else
+    if (disk->freeClusterCount != FILEIO_FREE_CLUSTER_COUNT_UNKNOWN)
+#endif
+    {
+        if ((oldValue = FILEIO_FATRead (disk, currentCluster)) == clusterFailValue)
+        {
+            return clusterFailValue;
+        }
+    }
+
     /* Settings based on FAT type */
     switch (disk->type)
     {
@@ -2741,45 +5214,30 @@ uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t
     l = disk->firstFatSector + (p / disk->sectorSize);     //
     p &= disk->sectorSize - 1;                 // Restrict 'p' within the FATbuffer size
 
-    if (disk->bufferStatusPtr->fatBufferCachedSector != l)
+    // Load the sector (if necessary) and mark it to be written back
+    if ((fatSector = FILEIO_FATCacheSectorGet (disk, l, true)) == NULL)
     {
-        // If we are loading a new sector then write
-        // the current one to the card if we need to
-        if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
-        {
-            return clusterFailValue;
-        }
-
-        // Load the new sector
-        if (!(*disk->driveConfig->funcSectorRead) (disk->mediaParameters, l, disk->fatBuffer))
-        {
-            statusPtr->fatBufferCachedSector = 0xFFFFFFFF;
-            return clusterFailValue;
-        }
-        else
-        {
-            statusPtr->fatBufferCachedSector = l;
-        }
+        return clusterFailValue;
     }
 
     if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT32)  // Refer page 16 of FAT requirement.
     {
-        *(disk->fatBuffer + p) = ((value & 0x000000ff));         // lsb,1st uint8_t of cluster value
-        *(disk->fatBuffer + p+1) = ((value & 0x0000ff00) >> 8);
-        *(disk->fatBuffer + p+2) = ((value & 0x00ff0000) >> 16);
-        *(disk->fatBuffer + p+3) = ((value & 0x0f000000) >> 24);   // the MSB nibble is supposed to be "0" in FAT32. So mask it.
+        *(fatSector + p) = ((value & 0x000000ff));         // lsb,1st uint8_t of cluster value
+        *(fatSector + p+1) = ((value & 0x0000ff00) >> 8);
+        *(fatSector + p+2) = ((value & 0x00ff0000) >> 16);
+        *(fatSector + p+3) = ((value & 0x0f000000) >> 24);   // the MSB nibble is supposed to be "0" in FAT32. So mask it.
     }
     else
     {
         if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT16)
         {
-            *(disk->fatBuffer+ p) = value;            //lsB
-            *(disk->fatBuffer + p+1) = ((value&0x0000ff00) >> 8);    // msB
+            *(fatSector + p) = value;            //lsB
+            *(fatSector + p+1) = ((value&0x0000ff00) >> 8);    // msB
         }
         else if (disk->type == FILEIO_FILE_SYSTEM_TYPE_FAT12)
         {
             // Get the current uint8_t from the FAT
-            c = *(disk->fatBuffer + p);
+            c = *(fatSector + p);
             if (q)
             {
                 c = ((value & 0x0F) << 4) | ( c & 0x0F);
@@ -2789,33 +5247,21 @@ uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t
                 c = (value & 0xFF);
             }
             // Write in those bits
-            *(disk->fatBuffer + p) = c;
+            *(fatSector + p) = c;
 
             // FAT12 entries can cross sector boundaries
             // Check if we need to load a new sector
             p = (p +1) & (disk->sectorSize-1);
             if (p == 0)
             {
-                // call this function to update the FAT on the card
-                if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
+                if ((fatSector = FILEIO_FATCacheSectorGet (disk, l + 1, true)) == NULL)
                 {
                     return clusterFailValue;
                 }
-
-                // Load the next sector
-                if (!(*disk->driveConfig->funcSectorRead) (disk->mediaParameters, l +1, disk->fatBuffer))
-                {
-                    statusPtr->fatBufferCachedSector = 0xFFFFFFFF;
-                    return clusterFailValue;
-                }
-                else
-                {
-                    statusPtr->fatBufferCachedSector = l + 1;
-                }
             }
 
             // Get the second uint8_t of the table entry
-            c = *(disk->fatBuffer + p);
+            c = *(fatSector + p);
             if (q)
             {
                 c = (value >> 4);
@@ -2824,10 +5270,33 @@ uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t
             {
                 c = ((value >> 8) & 0x0F) | (c & 0xF0);
             }
-            *(disk->fatBuffer + p) = c;
+            *(fatSector + p) = c;
+        }
+    }
+
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE)
+    FILEIO_ClusterBitmapUpdate (disk, currentCluster, (value != FILEIO_CLUSTER_VALUE_EMPTY));
+#endif
+
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    if ((oldValue == FILEIO_CLUSTER_VALUE_EMPTY) != (value == FILEIO_CLUSTER_VALUE_EMPTY))
+    {
+        FILEIO_FreeExtentUpdate (disk, currentCluster, (value != FILEIO_CLUSTER_VALUE_EMPTY));
+    }
+#endif
+
+    if (disk->freeClusterCount != FILEIO_FREE_CLUSTER_COUNT_UNKNOWN)
+    {
+        if ((oldValue == FILEIO_CLUSTER_VALUE_EMPTY) && (value != FILEIO_CLUSTER_VALUE_EMPTY))
+        {
+            disk->freeClusterCount--;
+        }
+        else if ((oldValue != FILEIO_CLUSTER_VALUE_EMPTY) && (value == FILEIO_CLUSTER_VALUE_EMPTY))
+        {
+            disk->freeClusterCount++;
         }
     }
-    statusPtr->flags.fatBufferNeedsWrite = true;
+    disk->fsInfoNeedsWrite = true;
 
     return 0;
 }
@@ -2866,31 +5335,179 @@ FILEIO_ERROR_TYPE FILEIO_NextClusterGet (FILEIO_OBJECT * fo, uint32_t count)
         currentCluster = fo->currentCluster;
         if ((nextCluster = FILEIO_FATRead( disk, currentCluster)) == clusterFailValue)
         {
-            error = FILEIO_ERROR_BAD_SECTOR_READ;
+            error = FILEIO_ERROR_BAD_SECTOR_READ;
+        }
+        else
+        {
+            // check if cluster value is valid
+            if (nextCluster >= (disk->partitionClusterCount + 2))
+            {
+                error = FILEIO_ERROR_INVALID_CLUSTER;
+            }
+
+            // compare against max value of a cluster in FAT
+            // return if eof
+            if (nextCluster >= lastClustervalue)    // check against eof
+            {
+                error = FILEIO_ERROR_EOF;
+            }
+        }
+
+        // update the file object structure
+        fo->currentCluster = nextCluster;
+
+    } while ((--count > 0) && (error == FILEIO_ERROR_NONE));// loop end
+
+    return(error);
+} // get next cluster
+
+void FILEIO_ExtentMapSet (FILEIO_OBJECT * filePtr, FILEIO_EXTENT * extentMap, uint16_t size)
+{
+    if ((extentMap == NULL) || (size == 0))
+    {
+        extentMap = NULL;
+        size = 0;
+    }
+
+    filePtr->extentMap = extentMap;
+    filePtr->extentMapSize = size;
+    filePtr->extentCount = 0;
+}
+
+void FILEIO_ExtentMapAdd (FILEIO_OBJECT * filePtr, uint32_t index, uint32_t cluster)
+{
+    FILEIO_EXTENT * extent;
+
+    if (filePtr->extentMap == NULL)
+    {
+        return;
+    }
+
+    if (filePtr->extentCount == 0)
+    {
+        // The first extent must start at the beginning of the file
+        if (index != 0)
+        {
+            return;
+        }
+        extent = filePtr->extentMap;
+    }
+    else
+    {
+        extent = filePtr->extentMap + filePtr->extentCount - 1;
+
+        // Only a cluster that directly follows the mapped part of the chain can be recorded
+        if (index != extent->fileCluster + extent->length)
+        {
+            return;
+        }
+
+        if (cluster == extent->diskCluster + extent->length)
+        {
+            extent->length++;
+            return;
+        }
+
+        if (filePtr->extentCount == filePtr->extentMapSize)
+        {
+            return;
+        }
+        extent++;
+    }
+
+    extent->fileCluster = index;
+    extent->diskCluster = cluster;
+    extent->length = 1;
+    filePtr->extentCount++;
+}
+
+FILEIO_ERROR_TYPE FILEIO_FileClusterGet (FILEIO_OBJECT * filePtr, uint32_t index)
+{
+    FILEIO_EXTENT * extent;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint32_t fileCluster = 0;
+    uint32_t cluster = filePtr->firstCluster;
+    uint16_t low = 0;
+    uint16_t high = filePtr->extentCount;
+    uint16_t middle;
+
+    // Find the last extent that starts at or before the requested cluster
+    while (low < high)
+    {
+        middle = (low + high) >> 1;
+        if (filePtr->extentMap[middle].fileCluster <= index)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low != 0)
+    {
+        extent = filePtr->extentMap + low - 1;
+        if (index < extent->fileCluster + extent->length)
+        {
+            filePtr->currentCluster = extent->diskCluster + (index - extent->fileCluster);
+            return FILEIO_ERROR_NONE;
+        }
+
+        // Continue from the last cluster of the extent
+        fileCluster = extent->fileCluster + extent->length - 1;
+        cluster = extent->diskCluster + extent->length - 1;
+    }
+    else
+    {
+        FILEIO_ExtentMapAdd (filePtr, 0, cluster);
+    }
+
+    // Follow the FAT the rest of the way
+    filePtr->currentCluster = cluster;
+    while (fileCluster < index)
+    {
+        if ((error = FILEIO_NextClusterGet (filePtr, 1)) != FILEIO_ERROR_NONE)
+        {
+            // Leave the file at the last cluster that was found
+            filePtr->currentCluster = cluster;
+            break;
         }
-        else
-        {
-            // check if cluster value is valid
-            if (nextCluster >= (disk->partitionClusterCount + 2))
-            {
-                error = FILEIO_ERROR_INVALID_CLUSTER;
-            }
+        cluster = filePtr->currentCluster;
+        fileCluster++;
+        FILEIO_ExtentMapAdd (filePtr, fileCluster, cluster);
+    }
 
-            // compare against max value of a cluster in FAT
-            // return if eof
-            if (nextCluster >= lastClustervalue)    // check against eof
-            {
-                error = FILEIO_ERROR_EOF;
-            }
-        }
+    return error;
+}
 
-        // update the file object structure
-        fo->currentCluster = nextCluster;
+FILEIO_ERROR_TYPE FILEIO_FileClusterNext (FILEIO_OBJECT * filePtr, uint32_t index)
+{
+    FILEIO_EXTENT * extent;
+    FILEIO_ERROR_TYPE error;
+    uint32_t cluster = filePtr->currentCluster;
 
-    } while ((--count > 0) && (error == FILEIO_ERROR_NONE));// loop end
+    // Use the extent map if it already describes the cluster
+    if (filePtr->extentCount != 0)
+    {
+        extent = filePtr->extentMap + filePtr->extentCount - 1;
+        if (index < extent->fileCluster + extent->length)
+        {
+            return FILEIO_FileClusterGet (filePtr, index);
+        }
+    }
 
-    return(error);
-} // get next cluster
+    if ((error = FILEIO_NextClusterGet (filePtr, 1)) == FILEIO_ERROR_NONE)
+    {
+        FILEIO_ExtentMapAdd (filePtr, index, filePtr->currentCluster);
+    }
+    else
+    {
+        filePtr->currentCluster = cluster;
+    }
+
+    return error;
+}
 
 
 int FILEIO_Close(FILEIO_OBJECT * filePtr)
@@ -2898,7 +5515,27 @@ int FILEIO_Close(FILEIO_OBJECT * filePtr)
     int result = FILEIO_RESULT_SUCCESS;
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-    result = FILEIO_Flush (filePtr);
+    // Free the clusters that were claimed ahead of the file's data or reused from the old contents but never written
+    if (filePtr->flags.writeEnabled && ((filePtr->windowEnd != 0) || filePtr->flags.truncateOnClose))
+    {
+        FILEIO_ERROR_TYPE error;
+
+        // A rewritten file's entry must stop referring to the old tail before the tail is freed
+        if (filePtr->flags.truncateOnClose && (FILEIO_Flush (filePtr) != FILEIO_RESULT_SUCCESS))
+        {
+            result = FILEIO_RESULT_FAILURE;
+        }
+        else if ((error = FILEIO_FileClustersRelease (filePtr)) != FILEIO_ERROR_NONE)
+        {
+            ((FILEIO_DRIVE *)filePtr->disk)->error = error;
+            result = FILEIO_RESULT_FAILURE;
+        }
+    }
+
+    if (FILEIO_Flush (filePtr) != FILEIO_RESULT_SUCCESS)
+    {
+        result = FILEIO_RESULT_FAILURE;
+    }
 #endif
 
     filePtr->flags.readEnabled = false;
@@ -2935,8 +5572,15 @@ int FILEIO_Flush (FILEIO_OBJECT * filePtr)
             return FILEIO_RESULT_FAILURE;
         }
 
-        // Write the current FAT sector to the disk
-        if (!FILEIO_FlushBuffer (filePtr->disk, FILEIO_BUFFER_FAT))
+        // Write the current FAT sector to the disk and bring the other FAT copies up to date
+        if (!FILEIO_FATMirrorSync (filePtr->disk))
+        {
+            ((FILEIO_DRIVE *)filePtr->disk)->error = FILEIO_ERROR_WRITE;
+            return FILEIO_RESULT_FAILURE;
+        }
+
+        // Update the free cluster count and next free cluster hint
+        if (!FILEIO_FSInfoWrite (filePtr->disk))
         {
             ((FILEIO_DRIVE *)filePtr->disk)->error = FILEIO_ERROR_WRITE;
             return FILEIO_RESULT_FAILURE;
@@ -3039,220 +5683,433 @@ int FILEIO_Seek(FILEIO_OBJECT * filePtr, int32_t offset, int whence)
             break;
    }
 
+    // start from the beginning
+    filePtr->currentCluster = filePtr->firstCluster;
+
+    if (offset2 > filePtr->size)
+    {
+        disk->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;      // past the limits
+    }
+    else
+    {
+        // set the new position
+        filePtr->absoluteOffset = offset2;
+
+        // figure out how many sectors
+        numsector = offset2 / disk->sectorSize;
+
+        // figure out how many bytes off of the offset
+        offset2 = offset2 - (numsector * disk->sectorSize);
+        filePtr->currentOffset = offset2;
+
+        // figure out how many clusters
+        temp = numsector / disk->sectorsPerCluster;
+
+        // figure out the stranded sectors
+        numsector = numsector - (disk->sectorsPerCluster * temp);
+        filePtr->currentSector = numsector;
+
+        // if we are in the current cluster stay there
+        if (temp > 0)
+        {
+            test = FILEIO_FileClusterGet(filePtr, temp);
+            if (test != FILEIO_ERROR_NONE)
+            {
+                // On EOF the file is left at its last cluster
+                if (test == FILEIO_ERROR_EOF)
+                {
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-    if (!FILEIO_FlushBuffer (filePtr->disk, FILEIO_BUFFER_DATA))
+                    if (filePtr->flags.writeEnabled)
+                    {
+                        if (FILEIO_ClusterAllocate (disk, &filePtr->currentCluster, 1, false) != FILEIO_ERROR_NONE)
+                        {
+                            disk->error = FILEIO_ERROR_COULD_NOT_GET_CLUSTER;
+                            return FILEIO_RESULT_FAILURE;
+                        }
+                        FILEIO_ExtentMapAdd (filePtr, temp, filePtr->currentCluster);
+                        // sec and currentOffset should already be zero
+                    }
+                    else
+#endif
+                    {
+                        filePtr->currentOffset = disk->sectorSize;
+                        filePtr->currentSector = disk->sectorsPerCluster - 1;
+                    }
+                }
+                else
+                {
+                    disk->error = FILEIO_ERROR_COULD_NOT_GET_CLUSTER;
+                    return FILEIO_RESULT_FAILURE;   // past the limits
+                }
+            }
+        }
+
+        // The selected sector will be loaded by the next read or write that needs it
+    }
+
+    disk->error = FILEIO_ERROR_NONE;
+
+    return FILEIO_RESULT_SUCCESS;
+}
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+size_t FILEIO_Write (const void * buffer, size_t size, size_t count, FILEIO_OBJECT * filePtr)
+{
+    FILEIO_ERROR_TYPE error;
+    uint8_t * data = (uint8_t *) buffer;
+    FILEIO_DRIVE * disk = filePtr->disk;
+    uint32_t currentSector, position, sectorCount, remaining, startCluster, cluster;
+    uint32_t clusterSize = (uint32_t)disk->sectorSize * disk->sectorsPerCluster;
+    size_t dataWritten = 0;
+    bool readSector;
+    uint16_t writeCount, startSector;
+    size_t length = size * count;
+
+    if (!filePtr->flags.writeEnabled)
     {
-        disk->error = FILEIO_ERROR_WRITE;
+        disk->error = FILEIO_ERROR_READ_ONLY;
+        return 0;
+    }
+
+    // Check to see if the user has passed in no data
+    if (length == 0)
+    {
+        disk->error = FILEIO_ERROR_NONE;
+        return 0;
+    }
+
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    if (FILEIO_GetSingleBuffer (disk) != FILEIO_RESULT_SUCCESS)
+    {
+        return 0;
+    }
+#endif
+
+    if ((*disk->driveConfig->funcWriteProtectGet)(disk->mediaParameters))
+    {
+        disk->error = FILEIO_ERROR_WRITE_PROTECTED;
+        return 0;
+    }
+
+    while (length != 0)
+    {
+        if (filePtr->currentOffset == disk->sectorSize)
+        {
+            filePtr->currentOffset = 0;
+            filePtr->currentSector++;
+            if (filePtr->currentSector == disk->sectorsPerCluster)
+            {
+                uint32_t index = (filePtr->absoluteOffset + dataWritten) / clusterSize;
+                filePtr->currentSector = 0;
+                // Load/allocate the next cluster
+                if ((error = FILEIO_FileClusterNext (filePtr, index)) == FILEIO_ERROR_EOF)
+                {
+                    // Allocate a new cluster
+                    error = FILEIO_FileClustersAllocate (filePtr, index, (length + clusterSize - 1) / clusterSize);
+                }
+
+                if (error != FILEIO_ERROR_NONE)
+                {
+                    disk->error = error;
+                    return dataWritten;
+                }
+            }
+        }
+
+        // Write whole sectors straight from the caller's buffer
+        if ((filePtr->currentOffset == 0) && (length >= disk->sectorSize))
+        {
+            position = filePtr->absoluteOffset + dataWritten;
+            remaining = length / disk->sectorSize;
+            startCluster = filePtr->currentCluster;
+            startSector = filePtr->currentSector;
+            currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster) + filePtr->currentSector;
+
+            sectorCount = disk->sectorsPerCluster - filePtr->currentSector;
+            if (sectorCount > remaining)
+            {
+                sectorCount = remaining;
+            }
+            filePtr->currentSector += sectorCount - 1;
+
+            // Extend the transfer through any allocated clusters that directly follow this one on the disk
+            while (sectorCount < remaining)
+            {
+                cluster = filePtr->currentCluster;
+                if ((FILEIO_FileClusterNext (filePtr, (position / clusterSize) + ((startSector + sectorCount) / disk->sectorsPerCluster)) != FILEIO_ERROR_NONE) ||
+                    (filePtr->currentCluster != cluster + 1))
+                {
+                    filePtr->currentCluster = cluster;
+                    break;
+                }
+                cluster = ((remaining - sectorCount) < disk->sectorsPerCluster) ? (remaining - sectorCount) : disk->sectorsPerCluster;
+                sectorCount += cluster;
+                filePtr->currentSector = cluster - 1;
+            }
+
+            if (!FILEIO_SectorsWrite (disk, currentSector, sectorCount, data))
+            {
+                filePtr->currentCluster = startCluster;
+                filePtr->currentSector = startSector;
+                disk->error = FILEIO_ERROR_WRITE;
+                return dataWritten;
+            }
+
+            // Any cached copies of these sectors are now stale
+            FILEIO_DataCacheDiscard (disk, currentSector, sectorCount);
+
+            // Leave the file at the end of the last sector that was written
+            filePtr->currentOffset = disk->sectorSize;
+            data += sectorCount * disk->sectorSize;
+            dataWritten += sectorCount * disk->sectorSize;
+            length -= sectorCount * disk->sectorSize;
+            continue;
+        }
+
+        currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster);
+        currentSector += filePtr->currentSector;
+
+        // Cache the required sector, if necessary
+        // The sector doesn't need to be read if all of the file data in it will be overwritten
+        position = filePtr->absoluteOffset + dataWritten;
+        readSector = (filePtr->currentOffset != 0) || ((length < disk->sectorSize) && ((position + length) < filePtr->size));
+        if ((error = FILEIO_DataCacheSectorGet (disk, currentSector, readSector)) != FILEIO_ERROR_NONE)
+        {
+            disk->error = error;
+            return dataWritten;
+        }
+
+        writeCount = ((disk->sectorSize - filePtr->currentOffset) > length) ? length : (disk->sectorSize - filePtr->currentOffset);
+        memcpy (disk->dataBuffer + filePtr->currentOffset, data, writeCount);
+        disk->bufferStatusPtr->flags.dataBufferNeedsWrite = true;
+        data += writeCount;
+        filePtr->currentOffset += writeCount;
+        dataWritten += writeCount;
+        length -= writeCount;
+    }
+
+    filePtr->absoluteOffset += dataWritten;
+    if(filePtr->absoluteOffset > filePtr->size)
+    {
+        filePtr->size = filePtr->absoluteOffset;
+    }
+
+    return dataWritten;
+}
+#endif
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+int FILEIO_Preallocate (FILEIO_OBJECT * filePtr, uint32_t bytes, uint8_t flags)
+{
+    FILEIO_ERROR_TYPE error;
+    FILEIO_DRIVE * disk = filePtr->disk;
+    uint32_t clusterSize = (uint32_t)disk->sectorSize * disk->sectorsPerCluster;
+    uint32_t savedCluster = filePtr->currentCluster;
+    uint32_t index, count, cluster, start, length, i, eofValue, clusterFailValue;
+
+    if (!filePtr->flags.writeEnabled)
+    {
+        disk->error = FILEIO_ERROR_READ_ONLY;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    if (FILEIO_GetSingleBuffer (disk) != FILEIO_RESULT_SUCCESS)
+    {
+        return FILEIO_RESULT_FAILURE;
+    }
+#endif
+
+    if ((*disk->driveConfig->funcWriteProtectGet)(disk->mediaParameters))
+    {
+        disk->error = FILEIO_ERROR_WRITE_PROTECTED;
         return FILEIO_RESULT_FAILURE;
     }
-#endif
 
-    // start from the beginning
-    filePtr->currentCluster = filePtr->firstCluster;
+    switch (disk->type)
+    {
+        case FILEIO_FILE_SYSTEM_TYPE_FAT12:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT12_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT32:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT32_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT32_FAIL;
+            break;
+        case FILEIO_FILE_SYSTEM_TYPE_FAT16:
+        default:
+            eofValue = FILEIO_CLUSTER_VALUE_FAT16_EOF;
+            clusterFailValue = FILEIO_CLUSTER_VALUE_FAT16_FAIL;
+            break;
+    }
+
+    // Clusters claimed ahead of the file's data become part of the preallocation
+    filePtr->windowStart = 0;
+    filePtr->windowEnd = 0;
 
-    if (offset2 > filePtr->size)
+    // Find the end of the file's cluster chain, stopping early if it is already long enough
+    count = (bytes == 0) ? 1 : (((bytes - 1) / clusterSize) + 1);
+    index = (filePtr->size == 0) ? 0 : ((filePtr->size - 1) / clusterSize);
+
+    if ((error = FILEIO_FileClusterGet (filePtr, index)) == FILEIO_ERROR_NONE)
     {
-        disk->error = FILEIO_ERROR_INVALID_ARGUMENT;
-        return FILEIO_RESULT_FAILURE;      // past the limits
+        while ((index + 1 < count) && ((error = FILEIO_FileClusterNext (filePtr, index + 1)) == FILEIO_ERROR_NONE))
+        {
+            index++;
+        }
     }
-    else
+    else if (error == FILEIO_ERROR_EOF)
     {
-        // set the new position
-        filePtr->absoluteOffset = offset2;
-
-        // figure out how many sectors
-        numsector = offset2 / disk->sectorSize;
-
-        // figure out how many bytes off of the offset
-        offset2 = offset2 - (numsector * disk->sectorSize);
-        filePtr->currentOffset = offset2;
-
-        // figure out how many clusters
-        temp = numsector / disk->sectorsPerCluster;
+        // The chain is shorter than the file
+        error = FILEIO_ERROR_INVALID_CLUSTER;
+    }
 
-        // figure out the stranded sectors
-        numsector = numsector - (disk->sectorsPerCluster * temp);
-        filePtr->currentSector = numsector;
+    if (error == FILEIO_ERROR_EOF)
+    {
+        error = FILEIO_ERROR_NONE;
+        count -= index + 1;
+        cluster = filePtr->currentCluster;
 
-        // if we are in the current cluster stay there
-        if (temp > 0)
+        // Try to continue the chain with a single run of free clusters
+        if ((error = FILEIO_FreeRunFind (disk, cluster + 1, count, &start, &length)) == FILEIO_ERROR_NONE)
         {
-            test = FILEIO_NextClusterGet(filePtr, temp);
-            if (test != FILEIO_ERROR_NONE)
+            if ((length < count) && ((flags & FILEIO_PREALLOCATE_CONTIGUOUS) != 0))
             {
-                if (test == FILEIO_ERROR_EOF)
+                error = FILEIO_ERROR_DRIVE_FULL;
+            }
+            else if (length != 0)
+            {
+                // Chain and terminate the whole run before linking it to the end of the file
+                for (i = start; (i < start + length) && (error == FILEIO_ERROR_NONE); i++)
                 {
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-                    if (filePtr->flags.writeEnabled)
-                    {
-                        // load the previous cluster
-                        filePtr->currentCluster = filePtr->firstCluster;
-                        // Don't perform this operation if there's only one cluster
-                        if (temp != 1)
-                        {
-                            test = FILEIO_NextClusterGet(filePtr, temp - 1);
-                        }
-                        if (FILEIO_ClusterAllocate (disk, &filePtr->currentCluster, false) != FILEIO_ERROR_NONE)
-                        {
-                            disk->error = FILEIO_ERROR_COULD_NOT_GET_CLUSTER;
-                            return FILEIO_RESULT_FAILURE;
-                        }
-                        // sec and currentOffset should already be zero
-                    }
-                    else
-#endif
+                    if (FILEIO_FATWrite (disk, i, (i == start + length - 1) ? eofValue : i + 1, false) == clusterFailValue)
                     {
-                        filePtr->currentCluster = filePtr->firstCluster;
-                        if (temp != 1)
-                        {
-                            test = FILEIO_NextClusterGet(filePtr, temp - 1);
-                        }
-                        else
-                        {
-                            test = FILEIO_ERROR_NONE;
-                        }
-                        if (test != FILEIO_ERROR_NONE)
-                        {
-                            disk->error = FILEIO_ERROR_COULD_NOT_GET_CLUSTER;
-                            return FILEIO_RESULT_FAILURE;
-                        }
-                        filePtr->currentOffset = disk->sectorSize;
-                        filePtr->currentSector = disk->sectorsPerCluster - 1;
+                        error = FILEIO_ERROR_WRITE;
                     }
                 }
-                else
+
+                if ((error == FILEIO_ERROR_NONE) && (FILEIO_FATWrite (disk, cluster, start, false) == clusterFailValue))
                 {
-                    disk->error = FILEIO_ERROR_COULD_NOT_GET_CLUSTER;
-                    return FILEIO_RESULT_FAILURE;   // past the limits
+                    error = FILEIO_ERROR_WRITE;
+                }
+
+                if (error == FILEIO_ERROR_NONE)
+                {
+                    for (i = start; i < start + length; i++)
+                    {
+                        FILEIO_ExtentMapAdd (filePtr, ++index, i);
+                    }
+                    count -= length;
+                    cluster = start + length - 1;
+                    disk->currentCluster = cluster;
                 }
             }
         }
 
-        // Determine the lba of the selected sector and load
-        temp = FILEIO_ClusterToSector(disk, filePtr->currentCluster);
-
-        // now the extra sectors
-        numsector = filePtr->currentSector;
-        temp += numsector;
-
-        if(!(*disk->driveConfig->funcSectorRead)(disk->mediaParameters, temp, disk->dataBuffer) )
+        // Allocate whatever didn't fit in the run one cluster at a time
+        while ((error == FILEIO_ERROR_NONE) && (count != 0))
         {
-            disk->error = FILEIO_ERROR_BAD_CACHE_READ;
-            return FILEIO_RESULT_FAILURE;   // Bad read
+            if ((error = FILEIO_ClusterAllocate (disk, &cluster, count, false)) == FILEIO_ERROR_NONE)
+            {
+                FILEIO_ExtentMapAdd (filePtr, ++index, cluster);
+                count--;
+            }
         }
-        disk->bufferStatusPtr->dataBufferCachedSector = temp;
     }
 
-    disk->error = FILEIO_ERROR_NONE;
+    filePtr->currentCluster = savedCluster;
 
-    return FILEIO_RESULT_SUCCESS;
+    if (error != FILEIO_ERROR_NONE)
+    {
+        disk->error = error;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    if (((flags & FILEIO_PREALLOCATE_EXTEND_SIZE) != 0) && (bytes > filePtr->size))
+    {
+        filePtr->size = bytes;
+    }
+
+    // Write the FAT and the directory entry
+    return FILEIO_Flush (filePtr);
 }
+#endif
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-size_t FILEIO_Write (const void * buffer, size_t size, size_t count, FILEIO_OBJECT * filePtr)
+int FILEIO_Truncate (FILEIO_OBJECT * filePtr, uint32_t newSize)
 {
     FILEIO_ERROR_TYPE error;
-    uint8_t * data = (uint8_t *) buffer;
     FILEIO_DRIVE * disk = filePtr->disk;
-    uint32_t currentSector;
-    size_t dataWritten = 0;
-    uint16_t writeCount;
-    size_t length = size * count;
+    uint32_t clusterSize = (uint32_t)disk->sectorSize * disk->sectorsPerCluster;
+    uint32_t keep, offset;
 
     if (!filePtr->flags.writeEnabled)
     {
         disk->error = FILEIO_ERROR_READ_ONLY;
-        return 0;
-    }
-
-    // Check to see if the user has passed in no data
-    if (length == 0)
-    {
-        disk->error = FILEIO_ERROR_NONE;
-        return 0;
+        return FILEIO_RESULT_FAILURE;
     }
 
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
     if (FILEIO_GetSingleBuffer (disk) != FILEIO_RESULT_SUCCESS)
     {
-        return 0;
+        return FILEIO_RESULT_FAILURE;
     }
 #endif
 
     if ((*disk->driveConfig->funcWriteProtectGet)(disk->mediaParameters))
     {
         disk->error = FILEIO_ERROR_WRITE_PROTECTED;
-        return 0;
+        return FILEIO_RESULT_FAILURE;
     }
 
-    while (length != 0)
+    if (newSize > filePtr->size)
     {
-        if (filePtr->currentOffset == disk->sectorSize)
-        {
-            filePtr->currentOffset = 0;
-            filePtr->currentSector++;
-            if (filePtr->currentSector == disk->sectorsPerCluster)
-            {
-                uint32_t tempCluster = filePtr->currentCluster;
-                filePtr->currentSector = 0;
-                // Load/allocate the next cluster
-                if ((error = FILEIO_NextClusterGet (filePtr, 1)) == FILEIO_ERROR_EOF)
-                {
-                    filePtr->currentCluster = tempCluster;
-                    // Allocate a new cluster
-                    error = FILEIO_ClusterAllocate (disk, &filePtr->currentCluster, false);
-                }
+        disk->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
 
-                if (error != FILEIO_ERROR_NONE)
-                {
-                    disk->error = error;
-                    return dataWritten;
-                }
-            }
-        }
+    // Write the new size before any cluster is freed, so the entry never refers to a freed cluster
+    filePtr->size = newSize;
+    if (FILEIO_Flush (filePtr) != FILEIO_RESULT_SUCCESS)
+    {
+        return FILEIO_RESULT_FAILURE;
+    }
 
-        currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster);
-        currentSector += filePtr->currentSector;
+    // Clusters claimed ahead of the file's data are freed with the rest of the tail
+    filePtr->windowStart = 0;
+    filePtr->windowEnd = 0;
+    filePtr->flags.truncateOnClose = false;
 
-        // Cache the required sector, if necessary
-        if (disk->bufferStatusPtr->dataBufferCachedSector != currentSector)
-        {
-            if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_DATA))
-            {
-                disk->error = FILEIO_ERROR_WRITE;
-                return FILEIO_ERROR_WRITE;
-            }
+    keep = (newSize == 0) ? 1 : (((newSize - 1) / clusterSize) + 1);
+    if ((error = FILEIO_FileClustersTruncate (filePtr, keep)) != FILEIO_ERROR_NONE)
+    {
+        disk->error = error;
+        return FILEIO_RESULT_FAILURE;
+    }
 
-            if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, currentSector, disk->dataBuffer) != true)
-            {
-                disk->error = FILEIO_ERROR_BAD_SECTOR_READ;
-                return dataWritten;
-            }
-            else
-            {
-                disk->bufferStatusPtr->dataBufferCachedSector = currentSector;
-#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-                disk->bufferStatusPtr->driveOwner = disk;
-#endif
-            }
+    // Move the current position back inside the file if it was cut off
+    offset = (filePtr->absoluteOffset > newSize) ? newSize : filePtr->absoluteOffset;
+    if ((offset == newSize) && (newSize != 0) && ((newSize % clusterSize) == 0))
+    {
+        // The end of the file is on a cluster boundary; stay at the end of the last cluster rather than
+        // letting FILEIO_Seek allocate the next one
+        if ((error = FILEIO_FileClusterGet (filePtr, keep - 1)) != FILEIO_ERROR_NONE)
+        {
+            disk->error = error;
+            return FILEIO_RESULT_FAILURE;
         }
-
-        writeCount = ((disk->sectorSize - filePtr->currentOffset) > length) ? length : (disk->sectorSize - filePtr->currentOffset);
-        memcpy (disk->dataBuffer + filePtr->currentOffset, data, writeCount);
-        disk->bufferStatusPtr->flags.dataBufferNeedsWrite = true;
-        data += writeCount;
-        filePtr->currentOffset += writeCount;
-        dataWritten += writeCount;
-        length -= writeCount;
+        filePtr->currentSector = disk->sectorsPerCluster - 1;
+        filePtr->currentOffset = disk->sectorSize;
+        filePtr->absoluteOffset = newSize;
     }
-
-    filePtr->absoluteOffset += dataWritten;
-    if(filePtr->absoluteOffset > filePtr->size)
+    else if (FILEIO_Seek (filePtr, offset, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS)
     {
-        filePtr->size = filePtr->absoluteOffset;
+        return FILEIO_RESULT_FAILURE;
     }
 
-    return dataWritten;
+    // Write the shortened chain
+    return FILEIO_Flush (filePtr);
 }
 #endif
 
@@ -3261,9 +6118,10 @@ size_t FILEIO_Read (void * buffer, size_t size, size_t count, FILEIO_OBJECT * fi
     FILEIO_ERROR_TYPE error;
     uint8_t * data = (uint8_t *) buffer;
     FILEIO_DRIVE * disk = filePtr->disk;
-    uint32_t currentSector;
+    uint32_t currentSector, sectorCount, remaining, startCluster, cluster;
+    uint32_t clusterSize = (uint32_t)disk->sectorSize * disk->sectorsPerCluster;
     size_t dataRead = 0;
-    uint16_t readCount;
+    uint16_t readCount, startSector;
     size_t length = size * count;
 
     if (!filePtr->flags.readEnabled)
@@ -3295,8 +6153,8 @@ size_t FILEIO_Read (void * buffer, size_t size, size_t count, FILEIO_OBJECT * fi
             if (filePtr->currentSector == disk->sectorsPerCluster)
             {
                 filePtr->currentSector = 0;
-                // Load/allocate the next cluster
-                error = FILEIO_NextClusterGet (filePtr, 1);
+                // Load the next cluster
+                error = FILEIO_FileClusterNext (filePtr, filePtr->absoluteOffset / clusterSize);
 
                 if (error != FILEIO_ERROR_NONE)
                 {
@@ -3306,61 +6164,186 @@ size_t FILEIO_Read (void * buffer, size_t size, size_t count, FILEIO_OBJECT * fi
             }
         }
 
-        currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster);
-        currentSector += filePtr->currentSector;
-
-        // Cache the required sector, if necessary
-        if (disk->bufferStatusPtr->dataBufferCachedSector != currentSector)
+        // Read whole sectors straight into the caller's buffer
+        if ((filePtr->currentOffset == 0) && (length >= disk->sectorSize) && ((filePtr->size - filePtr->absoluteOffset) >= disk->sectorSize))
         {
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-            if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_DATA))
+            remaining = (((filePtr->size - filePtr->absoluteOffset) < length) ? (filePtr->size - filePtr->absoluteOffset) : length) / disk->sectorSize;
+            startCluster = filePtr->currentCluster;
+            startSector = filePtr->currentSector;
+            currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster) + filePtr->currentSector;
+
+            sectorCount = disk->sectorsPerCluster - filePtr->currentSector;
+            if (sectorCount > remaining)
             {
-                disk->error = FILEIO_ERROR_WRITE;
-                return FILEIO_ERROR_WRITE;
+                sectorCount = remaining;
             }
-#endif
+            filePtr->currentSector += sectorCount - 1;
 
-            if ((*disk->driveConfig->funcSectorRead) (disk->mediaParameters, currentSector, disk->dataBuffer) != true)
+            // Extend the transfer through any clusters that directly follow this one on the disk
+            while (sectorCount < remaining)
             {
-                disk->error = FILEIO_ERROR_BAD_SECTOR_READ;
-                return dataRead;
+                cluster = filePtr->currentCluster;
+                if ((FILEIO_FileClusterNext (filePtr, (filePtr->absoluteOffset / clusterSize) + ((startSector + sectorCount) / disk->sectorsPerCluster)) != FILEIO_ERROR_NONE) ||
+                    (filePtr->currentCluster != cluster + 1))
+                {
+                    filePtr->currentCluster = cluster;
+                    break;
+                }
+                cluster = ((remaining - sectorCount) < disk->sectorsPerCluster) ? (remaining - sectorCount) : disk->sectorsPerCluster;
+                sectorCount += cluster;
+                filePtr->currentSector = cluster - 1;
             }
-            else
+
+            if ((error = FILEIO_DataSectorsRead (disk, currentSector, sectorCount, data)) != FILEIO_ERROR_NONE)
             {
-                disk->bufferStatusPtr->dataBufferCachedSector = currentSector;
+                filePtr->currentCluster = startCluster;
+                filePtr->currentSector = startSector;
+                disk->error = error;
+                return dataRead;
+            }
+
+            // Leave the file at the end of the last sector that was read
+            filePtr->currentOffset = disk->sectorSize;
+            data += sectorCount * disk->sectorSize;
+            filePtr->absoluteOffset += sectorCount * disk->sectorSize;
+            dataRead += sectorCount * disk->sectorSize;
+            length -= sectorCount * disk->sectorSize;
+            continue;
+        }
+
+        currentSector = FILEIO_ClusterToSector (disk, filePtr->currentCluster);
+        currentSector += filePtr->currentSector;
+
+        // Cache the required sector, if necessary
+        if ((error = FILEIO_DataCacheSectorGet (disk, currentSector, true)) != FILEIO_ERROR_NONE)
+        {
+            disk->error = error;
+            return dataRead;
+        }
+
+        readCount = ((disk->sectorSize - filePtr->currentOffset) > length) ? length : (disk->sectorSize - filePtr->currentOffset);
+        if ((filePtr->size - filePtr->absoluteOffset) < readCount)
+        {
+            readCount = filePtr->size - filePtr->absoluteOffset;
+            length = readCount;
+        }
+        memcpy (data, disk->dataBuffer + filePtr->currentOffset, readCount);
+        data += readCount;
+        filePtr->currentOffset += readCount;
+        filePtr->absoluteOffset += readCount;
+        dataRead += readCount;
+        length -= readCount;
+    }
+
+    return dataRead;
+}
+
+bool FILEIO_Eof (FILEIO_OBJECT * filePtr)
+{
+    return (filePtr->absoluteOffset == filePtr->size) ? true : false;
+}
+
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+int FILEIO_Remove (const uint16_t * pathName)
+{
+    FILEIO_OBJECT file;
+
+    return (FILEIO_FileRemove (pathName, &file, true) == FILEIO_ERROR_NONE) ? FILEIO_RESULT_SUCCESS : FILEIO_RESULT_FAILURE;
+}
+
+int FILEIO_RemoveIncremental (const uint16_t * pathName, FILEIO_REMOVE_STATE * state, uint32_t budget)
+{
+    FILEIO_OBJECT file;
+    FILEIO_DRIVE * disk;
+    FILEIO_ERROR_TYPE error;
+    uint32_t count;
+
+    // A removal that isn't in progress can't be continued
+    if (!state->new_request && (state->status != FILEIO_REMOVE_STILL_WORKING))
+    {
+        globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    // A call that can't free any clusters would never finish the removal.  The state is left as it is, so a removal in
+    // progress can still be continued.
+    if (budget == 0)
+    {
+        if (state->new_request)
+        {
+            globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        }
+        else
+        {
+            ((FILEIO_DRIVE *)state->private.disk)->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        }
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    if (state->new_request)
+    {
+        state->new_request = false;
+        state->clusters_freed = 0;
+
+        // The directory entry is written to the media before any cluster is freed, so an interrupted removal can only
+        // leave lost clusters behind
+        if (FILEIO_FileRemove (pathName, &file, false) != FILEIO_ERROR_NONE)
+        {
+            state->status = FILEIO_REMOVE_FAILED;
+            return FILEIO_RESULT_FAILURE;
+        }
+
+        state->private.disk = file.disk;
+        state->private.cluster = file.firstCluster;
+
+        if ((file.firstCluster == 0) || (file.firstCluster == ((FILEIO_DRIVE *)file.disk)->firstRootCluster))
+        {
+            state->status = FILEIO_REMOVE_COMPLETE;
+            return FILEIO_RESULT_SUCCESS;
+        }
+
+        state->status = FILEIO_REMOVE_STILL_WORKING;
+    }
+
+    disk = state->private.disk;
+
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
-                disk->bufferStatusPtr->driveOwner = disk;
+    if (FILEIO_GetSingleBuffer (disk) != FILEIO_RESULT_SUCCESS)
+    {
+        disk->error = FILEIO_ERROR_WRITE;
+        state->status = FILEIO_REMOVE_FAILED;
+        return FILEIO_RESULT_FAILURE;
+    }
 #endif
-            }
-        }
 
-        readCount = ((disk->sectorSize - filePtr->currentOffset) > length) ? length : (disk->sectorSize - filePtr->currentOffset);
-        if ((filePtr->size - filePtr->absoluteOffset) < readCount)
-        {
-            readCount = filePtr->size - filePtr->absoluteOffset;
-            length = readCount;
-        }
-        memcpy (data, disk->dataBuffer + filePtr->currentOffset, readCount);
-        data += readCount;
-        filePtr->currentOffset += readCount;
-        filePtr->absoluteOffset += readCount;
-        dataRead += readCount;
-        length -= readCount;
+    count = budget;
+    error = FILEIO_ClusterChainFree (disk, &state->private.cluster, &count);
+    state->clusters_freed += count;
+
+    if (!FILEIO_FlushBuffer (disk, FILEIO_BUFFER_FAT))
+    {
+        error = FILEIO_ERROR_WRITE;
     }
 
-    return dataRead;
-}
+    if (error == FILEIO_ERROR_NONE)
+    {
+        return FILEIO_RESULT_SUCCESS;
+    }
+    else if (error == FILEIO_ERROR_DONE)
+    {
+        state->status = FILEIO_REMOVE_COMPLETE;
+        return FILEIO_RESULT_SUCCESS;
+    }
 
-bool FILEIO_Eof (FILEIO_OBJECT * filePtr)
-{
-    return (filePtr->absoluteOffset == filePtr->size) ? true : false;
+    disk->error = error;
+    state->status = FILEIO_REMOVE_FAILED;
+    return FILEIO_RESULT_FAILURE;
 }
 
-#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
-int FILEIO_Remove (const uint16_t * pathName)
+// Finds the file at pathName and deletes its directory entry.  If eraseData is false, the file's cluster chain is left
+// allocated and its first cluster is returned in filePtr->firstCluster.  Sets the drive's error code on failure.
+FILEIO_ERROR_TYPE FILEIO_FileRemove (const uint16_t * pathName, FILEIO_OBJECT * filePtr, bool eraseData)
 {
-    FILEIO_OBJECT file;
-    FILEIO_OBJECT * filePtr = &file;
     FILEIO_ERROR_TYPE error;
     uint16_t entryHandle;
     FILEIO_DIRECTORY directory;
@@ -3374,7 +6357,7 @@ int FILEIO_Remove (const uint16_t * pathName)
     if (fileName == NULL)
     {
         globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
-        return FILEIO_RESULT_FAILURE;
+        return FILEIO_ERROR_INVALID_ARGUMENT;
     }
 
     currentCluster = directory.cluster;
@@ -3382,7 +6365,7 @@ int FILEIO_Remove (const uint16_t * pathName)
     if((*directory.drive->driveConfig->funcWriteProtectGet)(directory.drive->mediaParameters))
     {
         directory.drive->error = FILEIO_ERROR_WRITE_PROTECTED;
-        return FILEIO_RESULT_FAILURE;
+        return FILEIO_ERROR_WRITE_PROTECTED;
     }
 
     fileNameType = FILEIO_FileNameTypeGet(fileName, false);
@@ -3390,7 +6373,7 @@ int FILEIO_Remove (const uint16_t * pathName)
     if ((fileNameType == FILEIO_NAME_INVALID) || (fileNameType == FILEIO_NAME_DOT))
     {
         directory.drive->error = FILEIO_ERROR_INVALID_FILENAME;
-        return FILEIO_RESULT_FAILURE;
+        return FILEIO_ERROR_INVALID_FILENAME;
     }
     else if (fileNameType == FILEIO_NAME_SHORT)
     {
@@ -3422,7 +6405,7 @@ int FILEIO_Remove (const uint16_t * pathName)
         }
         else
         {
-            error = FILEIO_EraseFile (filePtr, &entryHandle, true);
+            error = FILEIO_EraseFile (filePtr, &entryHandle, eraseData);
         }
     }
 
@@ -3430,10 +6413,9 @@ int FILEIO_Remove (const uint16_t * pathName)
     if (error != FILEIO_ERROR_NONE)
     {
         directory.drive->error = error;
-        return FILEIO_RESULT_FAILURE;
     }
 
-    return FILEIO_RESULT_SUCCESS;
+    return error;
 }
 #endif
 
@@ -3551,6 +6533,22 @@ int FILEIO_Rename (const uint16_t * oldPathname, const uint16_t * newFilename)
         entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, entryHandle);
         FILEIO_FormatShortFileName (newFilename, filePtr);
         memcpy (entry->name, filePtr->name, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+        FILEIO_DirectoryIndexRemove (directory.drive, directory.cluster, entryHandle);
+        FILEIO_DirectoryIndexAdd (directory.drive, directory.cluster, entryHandle, (uint8_t *)filePtr->name, NULL);
+#endif
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+        if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+        {
+            FILEIO_PathCacheDrop (directory.drive, filePtr->firstCluster);
+        }
+#endif
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+        if ((filePtr->attributes & FILEIO_ATTRIBUTE_DIRECTORY) == FILEIO_ATTRIBUTE_DIRECTORY)
+        {
+            globalParameters.workingDirectoryPathLength = 0;
+        }
+#endif
     }
     else
     {
@@ -3577,7 +6575,13 @@ int FILEIO_Rename (const uint16_t * oldPathname, const uint16_t * newFilename)
             filePtr->lfnLen = FILEIO_strlen16 ((uint16_t *)newFilename);
         }
 
-        error = FILEIO_DirectoryEntryCreate (filePtr, filePtr->attributes, false);
+        if (FILEIO_DirectoryEntryCreate (filePtr, filePtr->attributes, false) != FILEIO_ERROR_NONE)
+        {
+            return FILEIO_RESULT_FAILURE;
+        }
+
+        // The new entry isn't necessarily where the old one was
+        entryHandle = filePtr->entry;
 
         entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, entryHandle);
 
@@ -3681,9 +6685,76 @@ int FILEIO_DirectoryChange (const uint16_t * path)
     globalParameters.currentWorkingDirectory.drive = directory.drive;
     globalParameters.currentWorkingDirectory.cluster = directory.cluster;
     globalParameters.currentWorkingDirectory.currentEntry = 0;
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    FILEIO_WorkingDirectoryPathUpdate (path);
+#endif
 
     return FILEIO_RESULT_SUCCESS;
 }
+
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+// Applies a path FILEIO_DirectoryChange just followed to the current working directory's path, using the same rules as
+// FILEIO_CacheDirectory.  The path becomes unknown if a directory's name can't be told from the path.
+void FILEIO_WorkingDirectoryPathUpdate (const uint16_t * path)
+{
+    uint16_t * workingPath = globalParameters.workingDirectoryPath;
+    uint16_t length = globalParameters.workingDirectoryPathLength;
+    uint16_t i;
+
+    // A drive specifier starts the path at that drive's root
+    if ((*path != 0) && (*(path + 1) == ':'))
+    {
+        workingPath[0] = *path;
+        workingPath[1] = ':';
+        length = 2;
+        path += 2;
+    }
+
+    while ((length != 0) && (*path != 0))
+    {
+        for (i = 0; (*(path + i) != 0) && (*(path + i) != FILEIO_CONFIG_DELIMITER); i++);
+
+        if ((i == 1) && (*path == '.'))
+        {
+            // Same directory
+        }
+        else if ((i == 2) && (*path == '.') && (*(path + 1) == '.'))
+        {
+            // Remove the last directory from the path.  The root doesn't have a parent.
+            if (length == 2)
+            {
+                length = 0;
+            }
+            else
+            {
+                while (workingPath[--length] != FILEIO_CONFIG_DELIMITER);
+            }
+        }
+        else if (i != 0)
+        {
+            // A short file name may also belong to a directory with a long file name, which is the name in the path
+            if ((FILEIO_FileNameTypeGet (path, false) != FILEIO_NAME_LONG) || (length + i + 1 > FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE))
+            {
+                length = 0;
+            }
+            else
+            {
+                workingPath[length++] = FILEIO_CONFIG_DELIMITER;
+                memcpy (workingPath + length, path, i * sizeof (uint16_t));
+                length += i;
+            }
+        }
+
+        path += i;
+        if (*path == FILEIO_CONFIG_DELIMITER)
+        {
+            path++;
+        }
+    }
+
+    globalParameters.workingDirectoryPathLength = length;
+}
+#endif
 #endif
 
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
@@ -3896,6 +6967,18 @@ uint16_t FILEIO_DirectoryGetCurrent (uint16_t * buffer, uint16_t size)
         return 0;
     }
 
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    // The path is kept by FILEIO_DirectoryChange while it's known
+    if (globalParameters.workingDirectoryPathLength != 0)
+    {
+        charCount = globalParameters.workingDirectoryPathLength;
+        index = (charCount < size) ? charCount : (size - 1);
+        memcpy (buffer, globalParameters.workingDirectoryPath, index * sizeof (uint16_t));
+        *(buffer + index) = 0;
+        return charCount;
+    }
+#endif
+
     bufferEnd = buffer + size - 1;
 
     // Loop backwards though all subdirectories
@@ -4050,10 +7133,11 @@ uint16_t FILEIO_DirectoryGetCurrent (uint16_t * buffer, uint16_t size)
 
 
     // Reverse the contents of the buffer.
-    // Point the index back at the last char in the string
+    // Point the index back at the last char in the string.  An index of 0 means the buffer wrapped on the drive ID,
+    // so the last char is at the end of the buffer.
     if (index == 0)
     {
-        index = size;
+        index = size - 1;
     }
     else
     {
@@ -4107,6 +7191,15 @@ uint16_t FILEIO_DirectoryGetCurrent (uint16_t * buffer, uint16_t size)
         *(buffer + tempIndex + 1) = 0;
     }
 
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    // Keep the whole path so it doesn't have to be found again
+    if (!bufferOverflow && (charCount <= FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE))
+    {
+        memcpy (globalParameters.workingDirectoryPath, buffer, charCount * sizeof (uint16_t));
+        globalParameters.workingDirectoryPathLength = charCount;
+    }
+#endif
+
     return charCount;
 }
 #endif
@@ -4193,69 +7286,247 @@ int FILEIO_Find (const uint16_t * fileName, unsigned int attr, FILEIO_SEARCH_REC
     record->timeStamp.time.value = file.time;
     record->timeStamp.timeMs = file.timeMs;
 
-    record->currentEntryOffset = file.entry + 1;
+    record->currentEntryOffset = file.entry + 1;
+
+    return FILEIO_RESULT_SUCCESS;
+}
+#endif
+
+#if !defined (FILEIO_CONFIG_SEARCH_DISABLE)
+int FILEIO_LongFileNameGet (FILEIO_SEARCH_RECORD * record, uint16_t * buffer, uint16_t length)
+{
+    uint32_t currentCluster = record->currentDirCluster;
+    uint16_t currentClusterOffset = record->currentClusterOffset;
+    uint16_t entryOffset = record->currentEntryOffset - 1;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    FILEIO_DIRECTORY directory;
+    uint8_t checksum = 0;
+    uint8_t * source;
+    uint16_t i;
+
+    directory.cluster = record->baseDirCluster;
+    directory.drive = FILEIO_CharToDrive(record->driveId);
+
+    if (directory.drive == NULL)
+    {
+        globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, entryOffset);
+    if ((entry == NULL) || (error != FILEIO_ERROR_NONE))
+    {
+        directory.drive->error = error;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+    checksum = 0;
+    source = (uint8_t *)entry->name;
+
+    for (i = 11; i != 0; i--)
+    {
+        checksum = ((checksum & 1) ? 0x80 : 0) + (checksum >> 1) + *source++;
+    }
+
+    if (FILEIO_LongFileNameCache(&directory, entryOffset, currentCluster, checksum) == FILEIO_LFN_SUCCESS)
+    {
+        i = FILEIO_strlen16 (lfnBuffer);
+        if (i < length)
+        {
+            length = i;
+        }
+
+        memcpy (buffer, lfnBuffer, (length + 1) << 1);
+
+        return FILEIO_RESULT_SUCCESS;
+    }
+    else
+    {
+        directory.drive->error = FILEIO_ERROR_NO_LONG_FILE_NAME;
+        return FILEIO_RESULT_FAILURE;
+    }
+}
+#endif
+
+int FILEIO_DirectoryOpen (FILEIO_DIRECTORY_OBJECT * handle, const uint16_t * path)
+{
+    FILEIO_DIRECTORY directory;
+    uint16_t * finalPath;
+
+    finalPath = FILEIO_CacheDirectory (&directory, (uint16_t *)path, false);
+
+    if (finalPath == NULL)
+    {
+        globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+#if !defined (FILEIO_CONFIG_DIRECTORY_DISABLE)
+    if (FILEIO_strlen16 (finalPath) != 0)
+    {
+        if (FILEIO_DirectoryChangeSingle (&directory, finalPath) != FILEIO_RESULT_SUCCESS)
+        {
+            directory.drive->error = FILEIO_ERROR_DIR_NOT_FOUND;
+            return FILEIO_RESULT_FAILURE;
+        }
+    }
+#endif
+
+    if (directory.cluster == 0)
+    {
+        directory.cluster = directory.drive->firstRootCluster;
+    }
+
+    handle->baseDirCluster = directory.cluster;
+    handle->currentDirCluster = directory.cluster;
+    handle->currentClusterOffset = 0;
+    handle->currentEntryOffset = 0;
+    handle->driveId = directory.drive->driveId;
+
+    return FILEIO_RESULT_SUCCESS;
+}
+
+int FILEIO_DirectoryRead (FILEIO_DIRECTORY_OBJECT * handle, FILEIO_DIRECTORY_RECORD * records, uint16_t count, unsigned int attr)
+{
+    FILEIO_DIRECTORY directory;
+    FILEIO_DIRECTORY_ENTRY * entry;
+    FILEIO_DIRECTORY_ENTRY_LFN * lfnEntry;
+    FILEIO_DIRECTORY_RECORD * record;
+    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
+    uint16_t entryOffset = handle->currentEntryOffset;
+    uint16_t recordCount = 0;
+    uint8_t sequenceNumber = 0;
+    uint8_t checksum = 0;
+    uint8_t entryChecksum;
+    uint8_t * source;
+    uint8_t i;
+
+    directory.cluster = handle->baseDirCluster;
+    directory.drive = FILEIO_CharToDrive (handle->driveId);
+
+    if (directory.drive == NULL)
+    {
+        globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
+        return FILEIO_RESULT_FAILURE;
+    }
+
+#if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
+    if (FILEIO_GetSingleBuffer (directory.drive) != FILEIO_RESULT_SUCCESS)
+    {
+        directory.drive->error = FILEIO_ERROR_WRITE;
+        return FILEIO_RESULT_FAILURE;
+    }
+#endif
+
+    while (recordCount < count)
+    {
+        record = records + recordCount;
+
+        entry = FILEIO_DirectoryEntryCache (&directory, &error, &handle->currentDirCluster, &handle->currentClusterOffset, entryOffset);
+        if (error == FILEIO_ERROR_DONE)
+        {
+            break;
+        }
+        else if (error != FILEIO_ERROR_NONE)
+        {
+            directory.drive->error = error;
+            return FILEIO_RESULT_FAILURE;
+        }
+
+        if (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY)
+        {
+            break;
+        }
+
+        if (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED)
+        {
+            sequenceNumber = 0;
+        }
+        else if (entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME)
+        {
+            // Long file name entries are stored last part first; collect each part into the record
+            lfnEntry = (FILEIO_DIRECTORY_ENTRY_LFN *)entry;
+            if ((lfnEntry->sequenceNumber & 0x40) == 0x40)
+            {
+                sequenceNumber = lfnEntry->sequenceNumber & 0x1F;
+                checksum = lfnEntry->checksum;
+                if ((sequenceNumber != 0) && (sequenceNumber <= FILEIO_LFN_ENTRIES_MAX))
+                {
+                    FILEIO_LongFileNamePartCopy (record->longFileName, lfnEntry, true);
+                }
+                else
+                {
+                    sequenceNumber = 0;
+                }
+            }
+            else if ((sequenceNumber > 1) && (lfnEntry->sequenceNumber == sequenceNumber - 1) && (lfnEntry->checksum == checksum))
+            {
+                sequenceNumber--;
+                FILEIO_LongFileNamePartCopy (record->longFileName, lfnEntry, false);
+            }
+            else
+            {
+                sequenceNumber = 0;
+            }
+        }
+        else if (entry->attributes == FILEIO_ATTRIBUTE_VOLUME)
+        {
+            sequenceNumber = 0;
+        }
+        else
+        {
+            if ((entry->attributes & attr) == entry->attributes)
+            {
+                entryChecksum = 0;
+                source = (uint8_t *)entry->name;
+
+                for (i = 11; i != 0; i--)
+                {
+                    entryChecksum = ((entryChecksum & 1) ? 0x80 : 0) + (entryChecksum >> 1) + *source++;
+                }
 
-    return FILEIO_RESULT_SUCCESS;
-}
+#ifndef FILEIO_CONFIG_DISABLE_WINDOWS_LFN_SHORTCUT_SUPPORT
+                if ((entry->reserved0 & 0x18) != 0)
+                {
+                    FILEIO_LongFileNameShortcutFormat (entry, record->longFileName);
+                }
+                else
 #endif
+                if ((sequenceNumber != 1) || (checksum != entryChecksum))
+                {
+                    record->longFileName[0] = 0;
+                }
 
-#if !defined (FILEIO_CONFIG_SEARCH_DISABLE)
-int FILEIO_LongFileNameGet (FILEIO_SEARCH_RECORD * record, uint16_t * buffer, uint16_t length)
-{
-    uint32_t currentCluster = record->currentDirCluster;
-    uint16_t currentClusterOffset = record->currentClusterOffset;
-    uint16_t entryOffset = record->currentEntryOffset - 1;
-    FILEIO_DIRECTORY_ENTRY * entry;
-    FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
-    FILEIO_DIRECTORY directory;
-    uint8_t checksum = 0;
-    uint8_t * source;
-    uint16_t i;
-
-    directory.cluster = record->baseDirCluster;
-    directory.drive = FILEIO_CharToDrive(record->driveId);
-
-    if (directory.drive == NULL)
-    {
-        globalParameters.currentWorkingDirectory.drive->error = FILEIO_ERROR_INVALID_ARGUMENT;
-        return FILEIO_RESULT_FAILURE;
-    }
-
-    entry = FILEIO_DirectoryEntryCache (&directory, &error, &currentCluster, &currentClusterOffset, entryOffset);
-    if ((entry == NULL) || (error != FILEIO_ERROR_NONE))
-    {
-        directory.drive->error = error;
-        return FILEIO_RESULT_FAILURE;
-    }
+                FILEIO_ShortFileNameConvert ((char *)record->shortFileName, entry->name);
+                record->attributes = entry->attributes;
+                record->fileSize = entry->fileSize;
+                record->firstCluster = FILEIO_FullClusterNumberGet (entry);
+                record->createTime.date.value = entry->createDate;
+                record->createTime.time.value = entry->createTime;
+                record->createTime.timeMs = entry->createTimeMs;
+                record->writeTime.date.value = entry->writeDate;
+                record->writeTime.time.value = entry->writeTime;
+                record->writeTime.timeMs = 0;
+                record->accessDate.value = entry->accessDate;
+
+                recordCount++;
+            }
 
-    checksum = 0;
-    source = (uint8_t *)entry->name;
+            sequenceNumber = 0;
+        }
 
-    for (i = 11; i != 0; i--)
-    {
-        checksum = ((checksum & 1) ? 0x80 : 0) + (checksum >> 1) + *source++;
-    }
+        entryOffset++;
 
-    if (FILEIO_LongFileNameCache(&directory, entryOffset, currentCluster, checksum) == FILEIO_LFN_SUCCESS)
-    {
-        i = FILEIO_strlen16 (lfnBuffer);
-        if (i < length)
+        // Only save the position between files, so a long file name is never split across calls
+        if (sequenceNumber == 0)
         {
-            length = i;
+            handle->currentEntryOffset = entryOffset;
         }
-
-        memcpy (buffer, lfnBuffer, (length + 1) << 1);
-
-        return FILEIO_RESULT_SUCCESS;
     }
-    else
-    {
-        directory.drive->error = FILEIO_ERROR_NO_LONG_FILE_NAME;
-        return FILEIO_RESULT_FAILURE;
-    }
-}
-#endif
 
+    return recordCount;
+}
 
 #if !defined (FILEIO_CONFIG_FORMAT_DISABLE)
 #if !defined (FILEIO_CONFIG_WRITE_DISABLE)
@@ -4275,40 +7546,31 @@ int FILEIO_CreateMBR (FILEIO_DRIVE_CONFIG * config, void * mediaParameters, uint
 
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
     bufferStatusPtr = &bufferStatus;
-    dataBuffer = gDataBuffer;
 
     // Use the last drive's buffer for this operation (it's the least likely to be in use)
     if (bufferStatusPtr->driveOwner != NULL)
     {
-        if (bufferStatusPtr->flags.dataBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (bufferStatusPtr->driveOwner, FILEIO_BUFFER_DATA))
         {
-            if (! (*((const FILEIO_DRIVE_CONFIG *)(bufferStatusPtr->driveOwner))->funcSectorWrite)(mediaParameters, bufferStatusPtr->dataBufferCachedSector, dataBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+            return false;
         }
     }
 
     bufferStatusPtr->driveOwner = NULL;
 #else
     bufferStatusPtr = &bufferStatus[FILEIO_CONFIG_MAX_DRIVES - 1];
-    dataBuffer = gDataBuffer[FILEIO_CONFIG_MAX_DRIVES - 1];
     // Use the last drive's buffer for this operation (it's the least likely to be in use)
     if (!gDriveSlotOpen[FILEIO_CONFIG_MAX_DRIVES - 1])
     {
-        if (bufferStatusPtr->flags.dataBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (&gDriveArray[FILEIO_CONFIG_MAX_DRIVES - 1], FILEIO_BUFFER_DATA))
         {
-            if (! (*config->funcSectorWrite)(config->mediaParameters, bufferStatusPtr->dataBufferCachedSector, dataBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+            return false;
         }
     }
 #endif
 
-    bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
+    FILEIO_DataCacheInvalidate (bufferStatusPtr);
+    dataBuffer = bufferStatusPtr->dataCache[bufferStatusPtr->dataCacheActive].buffer;
 
     memset (dataBuffer, 0x00, FILEIO_CONFIG_MEDIA_SECTOR_SIZE);
 
@@ -4397,62 +7659,45 @@ int FILEIO_Format (FILEIO_DRIVE_CONFIG * config, void * mediaParameters, FILEIO_
 
 #if defined (FILEIO_CONFIG_MULTIPLE_BUFFER_MODE_DISABLE)
     bufferStatusPtr = &bufferStatus;
-    d.dataBuffer = gDataBuffer;
-    d.fatBuffer = gFATBuffer;
+    d.fatBuffer = &gFATBuffer[0][0];
 
     if (bufferStatusPtr->driveOwner != NULL)
     {
-        FILEIO_DRIVE_CONFIG * bufferDriveConfig = (FILEIO_DRIVE_CONFIG *)((FILEIO_DRIVE *)bufferStatusPtr->driveOwner)->driveConfig;
-
-        if (bufferStatusPtr->flags.dataBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (bufferStatusPtr->driveOwner, FILEIO_BUFFER_DATA))
         {
-            if (!(*bufferDriveConfig->funcSectorWrite)(mediaParameters, bufferStatusPtr->dataBufferCachedSector, disk->dataBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+            return false;
         }
-        if (bufferStatusPtr->flags.fatBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (bufferStatusPtr->driveOwner, FILEIO_BUFFER_FAT))
         {
-            if (! (*bufferDriveConfig->funcSectorWrite)(mediaParameters, bufferStatusPtr->fatBufferCachedSector, disk->fatBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.fatBufferNeedsWrite = false;
+            return false;
         }
     }
 #else
     bufferStatusPtr = &bufferStatus[FILEIO_CONFIG_MAX_DRIVES - 1];
-    d.dataBuffer = gDataBuffer[FILEIO_CONFIG_MAX_DRIVES - 1];
-    d.fatBuffer = gFatBuffer[FILEIO_CONFIG_MAX_DRIVES - 1];
+    d.fatBuffer = &gFATBuffer[FILEIO_CONFIG_MAX_DRIVES - 1][0][0];
 
     if (!gDriveSlotOpen[FILEIO_CONFIG_MAX_DRIVES - 1])
     {
-        if (bufferStatusPtr->flags.dataBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (&gDriveArray[FILEIO_CONFIG_MAX_DRIVES - 1], FILEIO_BUFFER_DATA))
         {
-            if (!(*config->funcSectorWrite)(mediaParameters, bufferStatusPtr->dataBufferCachedSector, disk->dataBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.dataBufferNeedsWrite = false;
+            return false;
         }
-        if (bufferStatusPtr->flags.fatBufferNeedsWrite)
+        if (!FILEIO_FlushBuffer (&gDriveArray[FILEIO_CONFIG_MAX_DRIVES - 1], FILEIO_BUFFER_FAT))
         {
-            if (! (*config->funcSectorWrite)(mediaParameters, bufferStatusPtr->fatBufferCachedSector, disk->fatBuffer, false))
-            {
-                return false;
-            }
-            bufferStatusPtr->flags.fatBufferNeedsWrite = false;
+            return false;
         }
     }
 
 #endif
 
-    bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
-    bufferStatusPtr->fatBufferCachedSector = 0xFFFFFFFF;
+    FILEIO_DataCacheInvalidate (bufferStatusPtr);
+    d.dataBuffer = bufferStatusPtr->dataCache[bufferStatusPtr->dataCacheActive].buffer;
+    FILEIO_FATCacheInvalidate (bufferStatusPtr);
 
     disk->bufferStatusPtr = bufferStatusPtr;
     disk->driveConfig = config;
+    disk->mediaParameters = mediaParameters;
+    disk->sectorSize = FILEIO_CONFIG_MEDIA_SECTOR_SIZE;
 
     if(config->funcIOInit != NULL)
     {
@@ -4675,6 +7920,9 @@ int FILEIO_Format (FILEIO_DRIVE_CONFIG * config, void * mediaParameters, FILEIO_
                 disk->rootDirectoryEntryCount = 0x200;
 
                 disk->fatSectorCount = fatSize;
+
+                disk->partitionClusterCount = (sectorCount - 0x20 - (disk->fatCopyCount * fatSize)) / disk->sectorsPerCluster;
+                disk->fsInfoSector = disk->firstPartitionSector + 1;
             }
 
             // Non-file system specific values
@@ -4944,26 +8192,40 @@ int FILEIO_Format (FILEIO_DRIVE_CONFIG * config, void * mediaParameters, FILEIO_
             }
         }
 
-        memset (disk->dataBuffer, 0x00, 12);
-
-        for (index = disk->firstFatSector + 1; index < (disk->firstFatSector + disk->fatSectorCount); index++)
+        for (j = disk->fatCopyCount - 1; j != 0xFFFF; j--)
         {
-            for (j = disk->fatCopyCount - 1; j != 0xFFFF; j--)
+            if (!FILEIO_SectorsErase (disk, disk->firstFatSector + 1 + (j * disk->fatSectorCount), disk->fatSectorCount - 1))
             {
-                if ((*config->funcSectorWrite)(mediaParameters, index + (j * disk->fatSectorCount), disk->dataBuffer, false) == false)
-                {
-                    return FILEIO_RESULT_FAILURE;
-                }
+                return FILEIO_RESULT_FAILURE;
             }
         }
 
-        // Erase the root directory
-        for (index = 1; index < disk->sectorsPerCluster; index++)
+        // Write the FSInfo sector.  Every cluster except the root directory cluster is free.
+        if (disk->fsInfoSector != 0)
         {
-            if ((*config->funcSectorWrite)(mediaParameters, disk->firstRootSector + index, disk->dataBuffer, false) == false)
+            index = FILEIO_FSINFO_LEAD_SIGNATURE;
+            memcpy (&disk->dataBuffer[FSI_LEADSIG], &index, 4);
+            index = FILEIO_FSINFO_STRUCT_SIGNATURE;
+            memcpy (&disk->dataBuffer[FSI_STRUCSIG], &index, 4);
+            index = disk->partitionClusterCount - 1;
+            memcpy (&disk->dataBuffer[FSI_FREE_COUNT], &index, 4);
+            index = 2;
+            memcpy (&disk->dataBuffer[FSI_NXT_FREE], &index, 4);
+            index = FILEIO_FSINFO_TRAIL_SIGNATURE;
+            memcpy (&disk->dataBuffer[FSI_TRAILSIG], &index, 4);
+
+            if ((*config->funcSectorWrite)(mediaParameters, disk->fsInfoSector, disk->dataBuffer, false) == false)
             {
                 return FILEIO_RESULT_FAILURE;
             }
+
+            memset (disk->dataBuffer, 0x00, FILEIO_CONFIG_MEDIA_SECTOR_SIZE);
+        }
+
+        // Erase the root directory
+        if (!FILEIO_SectorsErase (disk, disk->firstRootSector + 1, disk->sectorsPerCluster - 1))
+        {
+            return FILEIO_RESULT_FAILURE;
         }
 
         if (volumeId != NULL)
@@ -5017,31 +8279,20 @@ int FILEIO_Format (FILEIO_DRIVE_CONFIG * config, void * mediaParameters, FILEIO_
             }
         }
 
-        memset (disk->dataBuffer, 0x00, 4);
-
-        for (index = disk->firstFatSector + 1; index < (disk->firstFatSector + disk->fatSectorCount); index++)
+        for (j = disk->fatCopyCount - 1; j != 0xFFFF; j--)
         {
-            for (j = disk->fatCopyCount - 1; j != 0xFFFF; j--)
+            if (!FILEIO_SectorsErase (disk, disk->firstFatSector + 1 + (j * disk->fatSectorCount), disk->fatSectorCount - 1))
             {
-                if ((*config->funcSectorWrite)(mediaParameters, index + (j * disk->fatSectorCount), disk->dataBuffer, false) == false)
-                {
-                    return FILEIO_RESULT_FAILURE;
-                }
+                return FILEIO_RESULT_FAILURE;
             }
         }
 
-		// Initialize the sector size
-        disk->sectorSize = FILEIO_CONFIG_MEDIA_SECTOR_SIZE;
-
         // Erase the root directory
         rootDirSectors = ((disk->rootDirectoryEntryCount * 32) + (disk->sectorSize - 1)) / disk->sectorSize;
 
-        for (index = 1; index < rootDirSectors; index++)
+        if (!FILEIO_SectorsErase (disk, disk->firstRootSector + 1, rootDirSectors - 1))
         {
-            if ((*config->funcSectorWrite)(mediaParameters, disk->firstRootSector + index, disk->dataBuffer, false) == false)
-            {
-                return FILEIO_RESULT_FAILURE;
-            }
+            return FILEIO_RESULT_FAILURE;
         }
 
         if (volumeId != NULL)
@@ -5115,6 +8366,14 @@ void FILEIO_DrivePropertiesGet(FILEIO_DRIVE_PROPERTIES * properties, uint16_t dr
         properties->results.sectors_per_cluster = drive->sectorsPerCluster;
         properties->results.total_clusters = drive->partitionClusterCount;
 
+        // No need to scan the FAT if the free cluster count is already known
+        if (drive->freeClusterCount != FILEIO_FREE_CLUSTER_COUNT_UNKNOWN)
+        {
+            properties->results.free_clusters = drive->freeClusterCount;
+            properties->properties_status = FILEIO_GET_PROPERTIES_NO_ERRORS;
+            return;
+        }
+
         /* Settings based on FAT type */
         switch (drive->type)
         {
@@ -5167,6 +8426,9 @@ void FILEIO_DrivePropertiesGet(FILEIO_DRIVE_PROPERTIES * properties, uint16_t dr
         // check if full circle done, disk full
         if ( properties->private.c == properties->private.curcls)
         {
+            // Remember the count; the FAT write functions will keep it current
+            drive->freeClusterCount = properties->results.free_clusters;
+            drive->fsInfoNeedsWrite = true;
             properties->properties_status = FILEIO_GET_PROPERTIES_NO_ERRORS;
             return;
         }
@@ -5230,8 +8492,9 @@ int FILEIO_GetSingleBuffer (FILEIO_DRIVE * drive)
         }
 
         drive->bufferStatusPtr->driveOwner = drive;
-        drive->bufferStatusPtr->dataBufferCachedSector = 0xFFFFFFFF;
-        drive->bufferStatusPtr->fatBufferCachedSector = 0xFFFFFFFF;
+        FILEIO_DataCacheInvalidate (drive->bufferStatusPtr);
+        drive->dataBuffer = drive->bufferStatusPtr->dataCache[drive->bufferStatusPtr->dataCacheActive].buffer;
+        FILEIO_FATCacheInvalidate (drive->bufferStatusPtr);
     }
 
     return FILEIO_RESULT_SUCCESS;
@@ -5242,61 +8505,144 @@ FILEIO_ERROR_TYPE FILEIO_FindLongFileName (FILEIO_DIRECTORY * directory, FILEIO_
 {
     FILEIO_ERROR_TYPE error = FILEIO_ERROR_NONE;
     FILEIO_DIRECTORY_ENTRY * entry;
-    uint8_t checksum, i;
+    FILEIO_DIRECTORY_ENTRY_LFN * lfnEntry;
+    uint8_t checksum = 0, entryChecksum, i;
+    uint8_t sequenceNumber = 0;
     uint8_t * source;
-    uint32_t currentClusterTemp;
-    uint16_t currentClusterOffsetTemp;
+    uint16_t nameLength, matchLength;
+    bool found;
+    bool chainUnknown = (entryOffset != 0);
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    uint16_t hash, position = 0;
+    uint8_t record;
+#endif
 
     if (*currentCluster == 0)
     {
         *currentCluster = directory->drive->firstRootCluster;
     }
-    
-    while(1)
+
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    // Only check the entries the directory index gives for the name
+    if ((mode == FILEIO_SEARCH_ENTRY_MATCH) && (entryOffset == 0) && ((record = FILEIO_DirectoryIndexGet (directory)) != FILEIO_DIRECTORY_INDEX_NONE))
     {
-        do
+        hash = FILEIO_DirectoryIndexHash (NULL, filePtr->lfnPtr);
+        while (FILEIO_DirectoryIndexNext (record, hash, &position, &entryOffset))
         {
-            entry = FILEIO_DirectoryEntryCache (directory, &error, currentCluster, currentClusterOffset, entryOffset);
-            if (error == FILEIO_ERROR_DONE)
-            {
-                break;
-            }
-            else if (error == FILEIO_ERROR_BAD_CACHE_READ)
+            if ((error = FILEIO_FindLongFileName (directory, filePtr, currentCluster, currentClusterOffset, entryOffset, attributes, FILEIO_SEARCH_ENTRY_MATCH | FILEIO_SEARCH_SINGLE_ENTRY)) != FILEIO_ERROR_DONE)
             {
-                directory->drive->error = FILEIO_ERROR_BAD_CACHE_READ;
                 return error;
             }
+        }
 
-            entryOffset++;
-        } while (((entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME) || (entry->attributes == FILEIO_ATTRIBUTE_VOLUME) || (((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED)) && (entry->name[0] != FILEIO_DIRECTORY_ENTRY_EMPTY));
+        return FILEIO_ERROR_DONE;
+    }
+#endif
 
-        if ((error == FILEIO_ERROR_DONE) || (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY))
+    // Characters past a '*' match anything, so only the characters before it need to be compared
+    nameLength = FILEIO_lfnlen (filePtr->lfnPtr);
+    matchLength = 0;
+    while ((matchLength < nameLength) && (((mode & FILEIO_SEARCH_PARTIAL_STRING_SEARCH) != FILEIO_SEARCH_PARTIAL_STRING_SEARCH) || (filePtr->lfnPtr[matchLength] != '*')))
+    {
+        matchLength++;
+    }
+
+    // Read each entry once, assembling long file names as their parts are found and dropping any name that can't match
+    while(1)
+    {
+        entry = FILEIO_DirectoryEntryCache (directory, &error, currentCluster, currentClusterOffset, entryOffset);
+        if (error == FILEIO_ERROR_DONE)
         {
             return FILEIO_ERROR_DONE;
         }
+        else if (error == FILEIO_ERROR_BAD_CACHE_READ)
+        {
+            directory->drive->error = FILEIO_ERROR_BAD_CACHE_READ;
+            return error;
+        }
 
-        currentClusterTemp = *currentCluster;
-        currentClusterOffsetTemp = *currentClusterOffset;
-
-        // Valid file entry was found
-        if (((mode & FILEIO_SEARCH_ENTRY_ATTRIBUTES) != FILEIO_SEARCH_ENTRY_ATTRIBUTES) || ((entry->attributes & attributes) == entry->attributes))
+        if (entry->name[0] == FILEIO_DIRECTORY_ENTRY_EMPTY)
         {
-            checksum = 0;
-            source = (uint8_t *)entry->name;
+            return FILEIO_ERROR_DONE;
+        }
 
-            for (i = 11; i != 0; i--)
+        if ((((uint8_t)entry->name[0]) == FILEIO_DIRECTORY_ENTRY_DELETED) || (entry->attributes == FILEIO_ATTRIBUTE_VOLUME))
+        {
+            sequenceNumber = 0;
+            chainUnknown = false;
+        }
+        else if (entry->attributes == FILEIO_ATTRIBUTE_LONG_NAME)
+        {
+            // Long file name entries are stored last part first, so the first entry gives the name's length
+            lfnEntry = (FILEIO_DIRECTORY_ENTRY_LFN *)entry;
+            if ((lfnEntry->sequenceNumber & 0x40) == 0x40)
+            {
+                chainUnknown = false;
+                sequenceNumber = lfnEntry->sequenceNumber & 0x1F;
+                checksum = lfnEntry->checksum;
+                if ((sequenceNumber != 0) && (sequenceNumber <= FILEIO_LFN_ENTRIES_MAX))
+                {
+                    FILEIO_LongFileNamePartCopy (lfnBuffer, lfnEntry, true);
+                    if ((FILEIO_strlen16 (lfnBuffer + ((sequenceNumber - 1) * FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY)) + ((sequenceNumber - 1) * FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY) != nameLength) ||
+                        !FILEIO_LongFileNamePartCompare (filePtr->lfnPtr, matchLength, sequenceNumber, mode))
+                    {
+                        sequenceNumber = 0;
+                    }
+                }
+                else
+                {
+                    sequenceNumber = 0;
+                }
+            }
+            else if ((sequenceNumber > 1) && (lfnEntry->sequenceNumber == sequenceNumber - 1) && (lfnEntry->checksum == checksum))
             {
-                checksum = ((checksum & 1) ? 0x80 : 0) + (checksum >> 1) + *source++;
+                sequenceNumber--;
+                FILEIO_LongFileNamePartCopy (lfnBuffer, lfnEntry, false);
+                if (!FILEIO_LongFileNamePartCompare (filePtr->lfnPtr, matchLength, sequenceNumber, mode))
+                {
+                    sequenceNumber = 0;
+                }
             }
-
-            if (FILEIO_LongFileNameCache(directory, entryOffset - 1, *currentCluster, checksum) == FILEIO_LFN_SUCCESS)
+            else
+            {
+                sequenceNumber = 0;
+            }
+        }
+        else
+        {
+            // Valid file entry was found
+            if (((mode & FILEIO_SEARCH_ENTRY_ATTRIBUTES) != FILEIO_SEARCH_ENTRY_ATTRIBUTES) || ((entry->attributes & attributes) == entry->attributes))
             {
-                // File's attributes are valid or we aren't trying to match attributes
-                if (FILEIO_LongFileNameCompare (filePtr->lfnPtr, mode) == true)
+                entryChecksum = 0;
+                source = (uint8_t *)entry->name;
+
+                for (i = 11; i != 0; i--)
+                {
+                    entryChecksum = ((entryChecksum & 1) ? 0x80 : 0) + (entryChecksum >> 1) + *source++;
+                }
+
+#ifndef FILEIO_CONFIG_DISABLE_WINDOWS_LFN_SHORTCUT_SUPPORT
+                if ((entry->reserved0 & 0x18) != 0)
+                {
+                    FILEIO_LongFileNameShortcutFormat (entry, lfnBuffer);
+                    found = FILEIO_LongFileNameCompare (filePtr->lfnPtr, mode);
+                }
+                else
+#endif
+                if (chainUnknown)
+                {
+                    // The search started partway through a name, so read the rest of it back from the short entry
+                    found = (FILEIO_LongFileNameCache (directory, entryOffset, *currentCluster, entryChecksum) == FILEIO_LFN_SUCCESS) && FILEIO_LongFileNameCompare (filePtr->lfnPtr, mode);
+                    entry = FILEIO_DirectoryEntryCache (directory, &error, currentCluster, currentClusterOffset, entryOffset);
+                }
+                else
                 {
-                    // Recache the short file name entry, just in case the LFN entry spans a cluster boundary
-                    entry = FILEIO_DirectoryEntryCache (directory, &error, &currentClusterTemp, &currentClusterOffsetTemp, entryOffset - 1);
+                    // Every part was compared as it was read
+                    found = (sequenceNumber == 1) && (checksum == entryChecksum);
+                }
 
+                if (found && (error == FILEIO_ERROR_NONE))
+                {
                     // Found a match.  Fill the result object with the file data
                     memcpy (filePtr->name, entry->name, FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX);
                     filePtr->disk = directory->drive;
@@ -5318,14 +8664,24 @@ FILEIO_ERROR_TYPE FILEIO_FindLongFileName (FILEIO_DIRECTORY * directory, FILEIO_
                         filePtr->time = entry->writeTime;
                         filePtr->date = entry->writeDate;
                     }
-                    filePtr->entry = --entryOffset;
+                    filePtr->entry = entryOffset;
                     filePtr->baseClusterDir = directory->cluster;
                     filePtr->currentClusterDir = directory->cluster;
 
                     return FILEIO_ERROR_NONE;
                 }
             }
+
+            if ((mode & FILEIO_SEARCH_SINGLE_ENTRY) == FILEIO_SEARCH_SINGLE_ENTRY)
+            {
+                return FILEIO_ERROR_DONE;
+            }
+
+            sequenceNumber = 0;
+            chainUnknown = false;
         }
+
+        entryOffset++;
     }
 }
 
@@ -5342,6 +8698,53 @@ static bool IsValidShortNameCharacter(char c)
     return true;
 }
 
+#ifndef FILEIO_CONFIG_DISABLE_WINDOWS_LFN_SHORTCUT_SUPPORT
+void FILEIO_LongFileNameShortcutFormat (FILEIO_DIRECTORY_ENTRY * sfnEntry, uint16_t * buffer)
+{
+    uint8_t sfnCharacterIndex;
+    uint8_t lfnCharacterIndex;
+
+    //Windows specific extension 
+    //  bit 3 = lower case base name ( 0x20 offset from upper case ASCII character )
+    //  bit 4 = lower case extension ( 0x20 offset from upper case ASCII character )
+    char basenameOffset  = ((sfnEntry->reserved0 & 0x08) != 0) ? 0x20 : 0;
+    char extensionOffset = ((sfnEntry->reserved0 & 0x10) != 0) ? 0x20 : 0;
+
+    lfnCharacterIndex = 0;
+    for(sfnCharacterIndex = 0; sfnCharacterIndex < 8; sfnCharacterIndex++)
+    {
+        char character = sfnEntry->name[sfnCharacterIndex];
+        if(IsValidShortNameCharacter(character))
+        {
+            buffer[lfnCharacterIndex] = (uint16_t)character;
+            if(isalpha(character))
+            {
+               buffer[lfnCharacterIndex] += basenameOffset;
+            }
+            lfnCharacterIndex++;
+        }              
+    }
+
+    buffer[lfnCharacterIndex++] = (uint16_t)'.';
+
+    for(sfnCharacterIndex = 8; sfnCharacterIndex < 11; sfnCharacterIndex++)
+    {
+        char character = sfnEntry->name[sfnCharacterIndex];
+        if(IsValidShortNameCharacter(character))
+        {   
+            buffer[lfnCharacterIndex] = (uint16_t)character;
+            if(isalpha(character))
+            {
+               buffer[lfnCharacterIndex] += extensionOffset;
+            }
+            lfnCharacterIndex++;
+        }
+    }
+
+    buffer[lfnCharacterIndex++] = 0; //null terminate
+}
+#endif
+
 FILEIO_LFN_ERROR FILEIO_LongFileNameCache (FILEIO_DIRECTORY * directory, uint16_t shortEntryOffset, uint32_t currentCluster, uint8_t checksum)
 {
     uint16_t i = 0;
@@ -5362,48 +8765,7 @@ FILEIO_LFN_ERROR FILEIO_LongFileNameCache (FILEIO_DIRECTORY * directory, uint16_
 
         if( (sfnEntry->reserved0 & 0x18) != 0)
         {
-            uint8_t sfnCharacterIndex;
-            uint8_t lfnCharacterIndex;
-
-            //Windows specific extension 
-            //  bit 3 = lower case base name ( 0x20 offset from upper case ASCII character )
-            //  bit 4 = lower case extension ( 0x20 offset from upper case ASCII character )
-            char basenameOffset  = ((sfnEntry->reserved0 & 0x08) != 0) ? 0x20 : 0;
-            char extensionOffset = ((sfnEntry->reserved0 & 0x10) != 0) ? 0x20 : 0;
-
-            lfnCharacterIndex = 0;
-            for(sfnCharacterIndex = 0; sfnCharacterIndex < 8; sfnCharacterIndex++)
-            {
-                char character = sfnEntry->name[sfnCharacterIndex];
-                if(IsValidShortNameCharacter(character))
-                {
-                    lfnBuffer[lfnCharacterIndex] = (uint16_t)character;
-                    if(isalpha(character))
-                    {
-                       lfnBuffer[lfnCharacterIndex] += basenameOffset;
-                    }
-                    lfnCharacterIndex++;
-                }              
-            }
-
-            lfnBuffer[lfnCharacterIndex++] = (uint16_t)'.';
-
-            for(sfnCharacterIndex = 8; sfnCharacterIndex < 11; sfnCharacterIndex++)
-            {
-                char character = sfnEntry->name[sfnCharacterIndex];
-                if(IsValidShortNameCharacter(character))
-                {   
-                    lfnBuffer[lfnCharacterIndex] = (uint16_t)character;
-                    if(isalpha(character))
-                    {
-                       lfnBuffer[lfnCharacterIndex] += extensionOffset;
-                    }
-                    lfnCharacterIndex++;
-                }
-            }
-
-            lfnBuffer[lfnCharacterIndex++] = 0; //null terminate
-
+            FILEIO_LongFileNameShortcutFormat (sfnEntry, lfnBuffer);
             return FILEIO_LFN_SUCCESS;
         }
     }
@@ -5462,6 +8824,51 @@ FILEIO_LFN_ERROR FILEIO_LongFileNameCache (FILEIO_DIRECTORY * directory, uint16_
     }
 }
 
+void FILEIO_LongFileNamePartCopy (uint16_t * buffer, FILEIO_DIRECTORY_ENTRY_LFN * lfnEntry, bool last)
+{
+    uint16_t part[FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY];
+    uint16_t i = ((lfnEntry->sequenceNumber & 0x1F) - 1) * FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY;
+    uint8_t j;
+
+    memcpy (part, &lfnEntry->namePart1, 10);
+    memcpy (part + 5, &lfnEntry->namePart2, 12);
+    memcpy (part + 11, &lfnEntry->namePart3, 4);
+
+    // Names can't be longer than 255 characters, so anything after that in the last part is padding
+    for (j = 0; (j < FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY) && (i < FILEIO_FILE_NAME_LENGTH_LFN - 1); j++)
+    {
+        buffer[i++] = part[j];
+    }
+
+    // The last part only contains a terminator if the name doesn't fill it
+    if (last)
+    {
+        buffer[i] = 0x0000;
+    }
+}
+
+bool FILEIO_LongFileNamePartCompare (uint16_t * fileName, uint16_t matchLength, uint8_t sequenceNumber, FILEIO_SEARCH_TYPE mode)
+{
+    uint16_t i = (sequenceNumber - 1) * FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY;
+    uint16_t end = i + FILEIO_FILE_NAME_UTF16_CHARS_IN_LFN_ENTRY;
+
+    if (end > matchLength)
+    {
+        end = matchLength;
+    }
+
+    // Compare the characters of one part in lfnBuffer against the same characters of the name
+    for (; i < end; i++)
+    {
+        if ((fileName[i] != lfnBuffer[i]) && (((mode & FILEIO_SEARCH_PARTIAL_STRING_SEARCH) != FILEIO_SEARCH_PARTIAL_STRING_SEARCH) || (fileName[i] != '?')))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool FILEIO_LongFileNameCompare (uint16_t * fileName, FILEIO_SEARCH_TYPE mode)
 {
     uint16_t nameLen;
@@ -32,13 +32,123 @@ please contact mla_licensing@microchip.com
 #define PACKED __attribute__((packed))
 #endif
 
+// Number of sectors held in the data sector cache of each buffer.  A value of 1 reproduces the single data buffer.
+#if !defined (FILEIO_CONFIG_DATA_CACHE_SECTORS)
+    #define FILEIO_CONFIG_DATA_CACHE_SECTORS        1
+#endif
+
+// Number of FAT sectors cached in each buffer, and the number of entries in each set of the FAT cache.
+// A FAT sector can only be cached in set (sector % (FILEIO_CONFIG_FAT_CACHE_SECTORS / FILEIO_CONFIG_FAT_CACHE_WAYS)).
+#if !defined (FILEIO_CONFIG_FAT_CACHE_SECTORS)
+    #define FILEIO_CONFIG_FAT_CACHE_SECTORS         1
+#endif
+
+#if !defined (FILEIO_CONFIG_FAT_CACHE_WAYS)
+    #define FILEIO_CONFIG_FAT_CACHE_WAYS            FILEIO_CONFIG_FAT_CACHE_SECTORS
+#endif
+
+#if ((FILEIO_CONFIG_FAT_CACHE_SECTORS % FILEIO_CONFIG_FAT_CACHE_WAYS) != 0)
+    #error "FILEIO_CONFIG_FAT_CACHE_SECTORS must be a multiple of FILEIO_CONFIG_FAT_CACHE_WAYS"
+#endif
+
+#define FILEIO_FAT_CACHE_SETS       (FILEIO_CONFIG_FAT_CACHE_SECTORS / FILEIO_CONFIG_FAT_CACHE_WAYS)
+
+// Size of the cluster allocation bitmap of each drive, in bytes.  Each bit describes one cluster; if the partition
+// has more clusters than the bitmap can describe, the bitmap covers one window of the FAT at a time.
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE)
+    #if ((FILEIO_CONFIG_CLUSTER_BITMAP_SIZE == 0) || ((FILEIO_CONFIG_CLUSTER_BITMAP_SIZE % 4) != 0))
+        #error "FILEIO_CONFIG_CLUSTER_BITMAP_SIZE must be a non-zero multiple of 4"
+    #endif
+
+    #define FILEIO_CLUSTER_BITMAP_WORDS     (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE / 4)
+    #define FILEIO_CLUSTER_BITMAP_BITS      ((uint32_t)FILEIO_CLUSTER_BITMAP_WORDS * 32)
+#endif
+
+// Number of clusters FILEIO_Write claims for a file at a time when the file needs a new cluster.  A value of 1 allocates
+// one cluster at a time.
+#if !defined (FILEIO_CONFIG_ALLOCATION_WINDOW)
+    #define FILEIO_CONFIG_ALLOCATION_WINDOW         1
+#endif
+
+// Maximum number of clusters that FILEIO_FATChainExtend can add to a chain at a time
+#define FILEIO_FAT_CHAIN_BATCH_SIZE     16
+
+// Number of clusters FILEIO_ClusterChainFree walks before it frees them together in cluster order
+#define FILEIO_FAT_FREE_BATCH_SIZE      32
+
+// Number of ranges of changed FAT sectors tracked for each drive in FILEIO_FAT_MIRRORING_DEFERRED mode.  When more
+// ranges are needed, the closest ones are merged.
+#define FILEIO_FAT_MIRROR_RANGE_COUNT   4
+
+// Number of free cluster runs held in the free extent index of each drive, used by the run allocation policies
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE)
+    #if ((FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE == 0) || (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE > 255))
+        #error "FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE must be between 1 and 255"
+    #endif
+#endif
+
+// Number of directories the directory index can describe at a time.  The name slots of the index are shared by these
+// directories; the least recently searched one is dropped to make room for another.
+#define FILEIO_DIRECTORY_INDEX_DIRECTORIES  4
+
+// Size of the directory index, in name slots
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+    #if ((FILEIO_CONFIG_DIRECTORY_INDEX_SIZE == 0) || (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE > 65535))
+        #error "FILEIO_CONFIG_DIRECTORY_INDEX_SIZE must be between 1 and 65535"
+    #endif
+#endif
+
+#define FILEIO_DIRECTORY_INDEX_NONE         0xFF        // No directory index record
+#define FILEIO_DIRECTORY_INDEX_SLOT_EMPTY   0x00        // The name slot has never been used
+#define FILEIO_DIRECTORY_INDEX_SLOT_DELETED 0xFF        // The name slot was used by a file that has been removed
+
+// Number of directories remembered by the path cache
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+    #if ((FILEIO_CONFIG_PATH_CACHE_SIZE == 0) || (FILEIO_CONFIG_PATH_CACHE_SIZE > 255))
+        #error "FILEIO_CONFIG_PATH_CACHE_SIZE must be between 1 and 255"
+    #endif
+#endif
+
+// Number of directories with a free entry hint
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+    #if ((FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE == 0) || (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE > 255))
+        #error "FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE must be between 1 and 255"
+    #endif
+#endif
+
+// Number of directories with a cluster chain map.  The least recently used map is replaced to make room for another.
+#define FILEIO_DIRECTORY_CHAIN_MAP_DIRECTORIES  4
+
+// Number of cluster runs in each directory cluster chain map
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+    #if ((FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE == 0) || (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE > 255))
+        #error "FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE must be between 1 and 255"
+    #endif
+#endif
+
+// Number of characters of the current working directory's path kept for FILEIO_DirectoryGetCurrent
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+    #if ((FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE < 2) || (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE > 65535))
+        #error "FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE must be between 2 and 65535"
+    #endif
+#endif
+
+// States of the FAT32 clean shutdown bit
+typedef enum
+{
+    FILEIO_VOLUME_STATE_UNTRACKED = 0,      // The bit isn't used (FAT12/16), or the volume wasn't clean when it was mounted
+    FILEIO_VOLUME_STATE_CLEAN,              // The bit is set on the media
+    FILEIO_VOLUME_STATE_IN_USE              // The bit has been cleared and will be set again when the drive is unmounted
+} FILEIO_VOLUME_STATE;
+
 // Private search parameters
 typedef enum
 {
     FILEIO_SEARCH_ENTRY_EMPTY = 0x01,
     FILEIO_SEARCH_ENTRY_MATCH = 0x02,
     FILEIO_SEARCH_PARTIAL_STRING_SEARCH = 0x04,
-    FILEIO_SEARCH_ENTRY_ATTRIBUTES = 0x08
+    FILEIO_SEARCH_ENTRY_ATTRIBUTES = 0x08,
+    FILEIO_SEARCH_SINGLE_ENTRY = 0x10           // Only check the first valid entry at or after the starting offset
 } FILEIO_SEARCH_TYPE;
 
 typedef enum
@@ -78,18 +188,54 @@ typedef enum
 #define FILEIO_FAT_GOOD_SIGN_0          0x55        // FAT signature byte 0
 #define FILEIO_FAT_GOOD_SIGN_1          0xAA        // FAT signatury byte 1
 
+// Entry in the data sector cache
+typedef struct
+{
+    uint8_t * buffer;                   // Address of the sector buffer for this entry
+    uint32_t sector;                    // Sector held in the buffer (0xFFFFFFFF if the entry is unused)
+    uint8_t age;                        // LRU rank of the entry (0 is the most recently used entry)
+    bool needsWrite;                    // Indicates that the buffer was modified and must be written back
+} FILEIO_DATA_CACHE_ENTRY;
+
+// The dataBufferCachedSector and dataBufferNeedsWrite fields describe the active cache entry (the one the
+// drive's dataBuffer points to).  The sector and needsWrite fields of the active entry itself are only
+// updated when another entry becomes active.
 typedef struct
 {
     uint32_t dataBufferCachedSector;
-    uint32_t fatBufferCachedSector;
     struct
     {
         unsigned dataBufferNeedsWrite : 1;
-        unsigned fatBufferNeedsWrite : 1;
     } flags;
     void * driveOwner;
+    FILEIO_DATA_CACHE_ENTRY dataCache[FILEIO_CONFIG_DATA_CACHE_SECTORS];
+    uint8_t dataCacheActive;            // Index of the active data cache entry
+    uint32_t fatCacheSector[FILEIO_CONFIG_FAT_CACHE_SECTORS];               // FAT sector held in each FAT cache entry
+    uint8_t fatCacheAge[FILEIO_CONFIG_FAT_CACHE_SECTORS];                   // LRU rank of each FAT cache entry within its set
+    uint8_t fatCacheDirty[(FILEIO_CONFIG_FAT_CACHE_SECTORS + 7) / 8];       // Bitmap of FAT cache entries that must be written back
 } FILEIO_BUFFER_STATUS;
 
+// A pending change to a FAT entry
+typedef struct
+{
+    uint32_t    cluster;                    // Cluster whose FAT entry is changed
+    uint32_t    value;                      // New value of the entry
+} FILEIO_FAT_UPDATE;
+
+// A run of free clusters in the free extent index
+typedef struct
+{
+    uint32_t    start;                      // First cluster of the run
+    uint32_t    length;                     // Number of clusters in the run
+} FILEIO_FREE_EXTENT;
+
+// A range of sectors of the first FAT copy that haven't been copied to the other FAT copies
+typedef struct
+{
+    uint32_t    start;                      // First sector of the range
+    uint32_t    end;                        // Sector following the range
+} FILEIO_FAT_MIRROR_RANGE;
+
 // Structure containing information about a device
 typedef struct
 {
@@ -114,8 +260,96 @@ typedef struct
     uint8_t     error;                      // Last error that occurred for this drive
     char        driveId;
     uint32_t    currentCluster;             // Current cluster on the drive for file creation purposes.
+    uint32_t    fsInfoSector;               // Logical block address of the FAT32 FSInfo sector (0 if there isn't one)
+    uint32_t    freeClusterCount;           // Number of free clusters on the drive, or FILEIO_FREE_CLUSTER_COUNT_UNKNOWN
+    uint8_t     fsInfoNeedsWrite;           // true if the free cluster count or next free cluster hint must be written to the FSInfo sector
+    uint8_t     volumeState;                // State of the FAT32 clean shutdown bit (see FILEIO_VOLUME_STATE)
+#if defined (FILEIO_CONFIG_CLUSTER_BITMAP_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    uint32_t *  clusterBitmap;              // Cluster allocation bitmap (a set bit marks an allocated cluster)
+    uint32_t    clusterBitmapBase;          // First cluster described by the allocation bitmap
+    uint32_t    clusterBitmapFree;          // Number of free clusters described by the allocation bitmap
+    bool        clusterBitmapValid;         // true if the allocation bitmap has been loaded from the FAT
+#endif
+    uint8_t     allocationPolicy;           // Policy used to choose new clusters (see FILEIO_ALLOCATION_POLICY)
+#if defined (FILEIO_CONFIG_FREE_EXTENT_INDEX_SIZE) && !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    FILEIO_FREE_EXTENT * freeExtents;       // The largest free cluster runs on the drive, sorted by first cluster
+    uint8_t     freeExtentCount;            // Number of runs in the free extent index
+    bool        freeExtentsValid;           // true if the free extent index has been built from the FAT
+    bool        freeExtentsComplete;        // true if the free extent index describes every free cluster on the drive
+#endif
+    uint8_t     fatMirroring;               // When the secondary FAT copies are updated (see FILEIO_FAT_MIRRORING)
+#if !defined (FILEIO_CONFIG_WRITE_DISABLE)
+    uint8_t     fatMirrorRangeCount;        // Number of ranges in fatMirrorRanges
+    FILEIO_FAT_MIRROR_RANGE fatMirrorRanges[FILEIO_FAT_MIRROR_RANGE_COUNT];    // Changed FAT sectors, sorted and disjoint
+#endif
 } PACKED FILEIO_DRIVE;
 
+// States of a directory in the directory index
+typedef enum
+{
+    FILEIO_DIRECTORY_INDEX_UNUSED = 0,      // The record doesn't describe a directory
+    FILEIO_DIRECTORY_INDEX_VALID,           // Every file in the directory has its names in the index
+    FILEIO_DIRECTORY_INDEX_OVERFLOW         // The directory has more names than the index can hold, so it is searched directly
+} FILEIO_DIRECTORY_INDEX_STATE;
+
+// A directory described by the directory index
+typedef struct
+{
+    FILEIO_DRIVE *  drive;                  // The drive containing the directory
+    uint32_t        cluster;                // The first cluster of the directory
+    uint32_t        lastUse;                // Value of the index's use counter when the directory was last searched
+    uint8_t         state;                  // State of the record (see FILEIO_DIRECTORY_INDEX_STATE)
+} FILEIO_DIRECTORY_INDEX_RECORD;
+
+// A name in the directory index
+typedef struct
+{
+    uint16_t        hash;                   // Hash of the file's short or long name
+    uint16_t        entry;                  // Offset of the file's short name entry in its directory
+    uint8_t         directory;              // Number of the directory's record plus 1, or FILEIO_DIRECTORY_INDEX_SLOT_EMPTY/DELETED
+} FILEIO_DIRECTORY_INDEX_SLOT;
+
+// A directory the path cache has found by name
+typedef struct
+{
+    FILEIO_DRIVE *  drive;                  // The drive containing the directory, or NULL if the entry is unused
+    uint32_t        parent;                 // The first cluster of the directory containing the directory
+    uint32_t        cluster;                // The first cluster of the directory
+    uint32_t        lastUse;                // Value of the cache's use counter when the entry was last used
+    uint8_t         name[FILEIO_FILE_NAME_LENGTH_8P3_NO_RADIX];    // The short name of the directory
+} FILEIO_PATH_CACHE_ENTRY;
+
+// Where the free entries of a directory are, as far as FILEIO_DirectoryEntryFindEmpty knows
+typedef struct
+{
+    FILEIO_DRIVE *  drive;                  // The drive containing the directory, or NULL if the hint is unused
+    uint32_t        cluster;                // The first cluster of the directory
+    uint32_t        lastUse;                // Value of the hints' use counter when the hint was last used
+    uint16_t        firstFree;              // Offset of the first entry that may be free; the entries before it are in use
+    uint16_t        freeLength;             // Number of free entries known to start at firstFree, or 0 if not known
+    uint16_t        end;                    // Offset of the entry from which every entry is free
+} FILEIO_FREE_ENTRY_HINT;
+
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+// A run of contiguous clusters in a directory
+typedef struct
+{
+    uint32_t        cluster;                // The first cluster of the run
+    uint16_t        offset;                 // Index of the first cluster of the run within the directory
+} FILEIO_DIRECTORY_CHAIN_RUN;
+
+// The clusters of a directory, as far as FILEIO_DirectoryEntryCache has followed its chain
+typedef struct
+{
+    FILEIO_DRIVE *  drive;                  // The drive containing the directory, or NULL if the map is unused
+    uint32_t        cluster;                // The first cluster of the directory
+    uint32_t        lastUse;                // Value of the maps' use counter when the map was last used
+    uint16_t        length;                 // Number of clusters at the start of the chain described by the map
+    uint8_t         runCount;               // Number of runs in the map
+    FILEIO_DIRECTORY_CHAIN_RUN runs[FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE];     // The runs, in chain order
+} FILEIO_DIRECTORY_CHAIN_MAP;
+#endif
+
 typedef struct
 {
     uint16_t currentEntry;
@@ -257,11 +491,32 @@ typedef struct {
 #define  BSI_FATSZ32       36
 // A macro for the boot sector start cluster of root directory value offset
 #define  BSI_ROOTCLUS      44
+// A macro for the FAT32 boot sector FSInfo sector number offset
+#define  BSI_FSINFO        48
 //  A macro for the FAT32 boot sector boot signature offset
 #define  BSI_FAT32_BOOTSIG 66
 // A macro for the FAT32 boot sector file system type string offset
 #define  BSI_FAT32_FSTYPE  82
 
+// A macro for the FSInfo sector lead signature offset
+#define FSI_LEADSIG         0
+// A macro for the FSInfo sector structure signature offset
+#define FSI_STRUCSIG        484
+// A macro for the FSInfo sector free cluster count offset
+#define FSI_FREE_COUNT      488
+// A macro for the FSInfo sector next free cluster hint offset
+#define FSI_NXT_FREE        492
+// A macro for the FSInfo sector trail signature offset
+#define FSI_TRAILSIG        508
+
+#define FILEIO_FSINFO_LEAD_SIGNATURE        0x41615252      // FSInfo sector lead signature
+#define FILEIO_FSINFO_STRUCT_SIGNATURE      0x61417272      // FSInfo sector structure signature
+#define FILEIO_FSINFO_TRAIL_SIGNATURE       0xAA550000      // FSInfo sector trail signature
+#define FILEIO_FREE_CLUSTER_COUNT_UNKNOWN   0xFFFFFFFF      // Free cluster count value indicating the count is not known
+
+// Mask of the clean shutdown bit in the high byte of the second FAT32 FAT entry
+#define FILEIO_FAT32_CLEAN_SHUTDOWN_MASK    0x08
+
 
 // Structure of a partition table entry
 typedef struct
@@ -307,6 +562,9 @@ typedef struct
 
 FILEIO_ERROR_TYPE FILEIO_LoadMBR (FILEIO_DRIVE * drive);
 FILEIO_ERROR_TYPE FILEIO_LoadBootSector (FILEIO_DRIVE * drive);
+void FILEIO_FSInfoLoad (FILEIO_DRIVE * drive);
+bool FILEIO_FSInfoWrite (FILEIO_DRIVE * drive);
+bool FILEIO_VolumeStateSet (FILEIO_DRIVE * drive, FILEIO_VOLUME_STATE state);
 uint32_t FILEIO_FullClusterNumberGet(FILEIO_DIRECTORY_ENTRY * entry);
 uint32_t FILEIO_ClusterToSector(FILEIO_DRIVE * disk, uint32_t cluster);
 FILEIO_DRIVE * FILEIO_CharToDrive (char c);
@@ -314,25 +572,92 @@ const char * FILEIO_CacheDirectory (FILEIO_DIRECTORY * dir, const char * path, b
 uint16_t FILEIO_FindNextDelimiter(const char * path);
 FILEIO_RESULT FILEIO_DirectoryMakeSingle (FILEIO_DIRECTORY * dir, const char * path);
 FILEIO_RESULT FILEIO_DirectoryChangeSingle (FILEIO_DIRECTORY * dir, const char * path);
+#if defined (FILEIO_CONFIG_WORKING_DIRECTORY_PATH_SIZE)
+void FILEIO_WorkingDirectoryPathUpdate (const char * path);
+#endif
+#if defined (FILEIO_CONFIG_PATH_CACHE_SIZE)
+bool FILEIO_PathCacheFind (FILEIO_DIRECTORY * directory, const uint8_t * shortName);
+void FILEIO_PathCacheAdd (FILEIO_DIRECTORY * directory, const uint8_t * shortName, uint32_t cluster);
+void FILEIO_PathCacheDrop (FILEIO_DRIVE * drive, uint32_t cluster);
+void FILEIO_PathCacheDriveDrop (FILEIO_DRIVE * drive);
+#endif
 int FILEIO_DirectoryRemoveSingle (FILEIO_DIRECTORY * directory, char * path);
 void FILEIO_FormatShortFileName (const char * fileName, FILEIO_OBJECT * filePtr);
 uint8_t FILEIO_FileNameTypeGet (const char * fileName, bool partialStringSearch);
 bool FILEIO_ShortFileNameCompare (uint8_t * fileName1, uint8_t * fileName2, uint8_t mode);
 uint32_t FILEIO_FATWrite (FILEIO_DRIVE *disk, uint32_t currentCluster, uint32_t value, uint8_t forceWrite);
+uint32_t FILEIO_FATSectorGet (FILEIO_DRIVE * disk, uint32_t cluster);
+FILEIO_ERROR_TYPE FILEIO_FATWriteBatch (FILEIO_DRIVE * disk, FILEIO_FAT_UPDATE * updates, uint16_t count);
+FILEIO_ERROR_TYPE FILEIO_FATChainExtend (FILEIO_DRIVE * disk, uint32_t previousCluster, const uint32_t * clusters, uint16_t count);
 uint32_t FILEIO_FATRead (FILEIO_DRIVE * disk, uint32_t currentCluster);
 FILEIO_DIRECTORY_ENTRY * FILEIO_DirectoryEntryCache (FILEIO_DIRECTORY * directory, FILEIO_ERROR_TYPE * error, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset);
+#if defined (FILEIO_CONFIG_DIRECTORY_CHAIN_MAP_SIZE)
+FILEIO_DIRECTORY_CHAIN_MAP * FILEIO_DirectoryChainMapGet (FILEIO_DIRECTORY * directory);
+void FILEIO_DirectoryChainMapFind (FILEIO_DIRECTORY_CHAIN_MAP * map, uint16_t clusterOffset, uint32_t * currentCluster, uint16_t * currentClusterOffset);
+void FILEIO_DirectoryChainMapAdd (FILEIO_DIRECTORY_CHAIN_MAP * map, uint16_t clusterOffset, uint32_t cluster);
+void FILEIO_DirectoryChainMapDrop (FILEIO_DRIVE * drive, uint32_t cluster);
+void FILEIO_DirectoryChainMapDriveDrop (FILEIO_DRIVE * drive);
+#endif
 bool FILEIO_FlushBuffer (FILEIO_DRIVE * disk, FILEIO_BUFFER_ID bufferId);
+void FILEIO_DataCacheInitialize (FILEIO_BUFFER_STATUS * bufferStatusPtr, uint8_t * buffer);
+void FILEIO_DataCacheInvalidate (FILEIO_BUFFER_STATUS * bufferStatusPtr);
+void FILEIO_DataCacheDiscard (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count);
+FILEIO_ERROR_TYPE FILEIO_DataCacheSectorGet (FILEIO_DRIVE * disk, uint32_t sector, bool readSector);
+FILEIO_ERROR_TYPE FILEIO_DataSectorsRead (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer);
+bool FILEIO_SectorsRead (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer);
+bool FILEIO_SectorsWrite (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count, uint8_t * buffer);
+bool FILEIO_SectorsErase (FILEIO_DRIVE * disk, uint32_t sector, uint32_t count);
+void FILEIO_FATCacheInvalidate (FILEIO_BUFFER_STATUS * bufferStatusPtr);
+uint8_t * FILEIO_FATCacheSectorGet (FILEIO_DRIVE * disk, uint32_t sector, bool markDirty);
+bool FILEIO_FATCacheEntryWrite (FILEIO_DRIVE * disk, uint8_t index);
+void FILEIO_FATMirrorMark (FILEIO_DRIVE * disk, uint32_t sector);
+bool FILEIO_FATMirrorSync (FILEIO_DRIVE * disk);
 FILEIO_ERROR_TYPE FILEIO_EraseClusterChain (uint32_t cluster, FILEIO_DRIVE * disk);
+FILEIO_ERROR_TYPE FILEIO_ClusterChainFree (FILEIO_DRIVE * disk, uint32_t * cluster, uint32_t * count);
 FILEIO_ERROR_TYPE FILEIO_DirectoryEntryCreate (FILEIO_OBJECT * filePtr, uint8_t attributes, bool allocateDataCluster);
-FILEIO_ERROR_TYPE FILEIO_ClusterAllocate (FILEIO_DRIVE * drive, uint32_t * cluster, bool eraseCluster);
+FILEIO_ERROR_TYPE FILEIO_ClusterAllocate (FILEIO_DRIVE * drive, uint32_t * cluster, uint32_t count, bool eraseCluster);
+uint32_t FILEIO_ClusterSelect (FILEIO_DRIVE * drive, uint32_t previousCluster, uint32_t count);
+FILEIO_ERROR_TYPE FILEIO_FileClustersAllocate (FILEIO_OBJECT * filePtr, uint32_t index, uint32_t count);
+FILEIO_ERROR_TYPE FILEIO_FileClustersRelease (FILEIO_OBJECT * filePtr);
+FILEIO_ERROR_TYPE FILEIO_FileClustersTruncate (FILEIO_OBJECT * filePtr, uint32_t count);
+#if defined (FILEIO_CONFIG_DIRECTORY_INDEX_SIZE)
+uint16_t FILEIO_DirectoryIndexHash (const uint8_t * shortName);
+uint8_t FILEIO_DirectoryIndexRecordFind (FILEIO_DRIVE * drive, uint32_t cluster);
+uint8_t FILEIO_DirectoryIndexGet (FILEIO_DIRECTORY * directory);
+bool FILEIO_DirectoryIndexNext (uint8_t record, uint16_t hash, uint16_t * position, uint16_t * entry);
+bool FILEIO_DirectoryIndexInsert (uint8_t record, uint16_t hash, uint16_t entry);
+void FILEIO_DirectoryIndexAdd (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry, const uint8_t * shortName);
+void FILEIO_DirectoryIndexRemove (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry);
+void FILEIO_DirectoryIndexDrop (FILEIO_DRIVE * drive, uint32_t cluster);
+void FILEIO_DirectoryIndexDriveDrop (FILEIO_DRIVE * drive);
+void FILEIO_DirectoryIndexRecordDrop (uint8_t number);
+#endif
 FILEIO_ERROR_TYPE FILEIO_EraseCluster (FILEIO_DRIVE * drive, uint32_t cluster);
 uint32_t FILEIO_FindEmptyCluster (FILEIO_DRIVE * drive);
+FILEIO_ERROR_TYPE FILEIO_FreeRunFind (FILEIO_DRIVE * drive, uint32_t baseCluster, uint32_t count, uint32_t * start, uint32_t * length);
+FILEIO_ERROR_TYPE FILEIO_ClusterBitmapLoad (FILEIO_DRIVE * drive, uint32_t baseCluster);
+uint32_t FILEIO_ClusterBitmapFind (FILEIO_DRIVE * drive);
+void FILEIO_ClusterBitmapUpdate (FILEIO_DRIVE * drive, uint32_t cluster, bool allocated);
+FILEIO_ERROR_TYPE FILEIO_FreeExtentIndexBuild (FILEIO_DRIVE * drive);
+void FILEIO_FreeExtentInsert (FILEIO_DRIVE * drive, uint32_t start, uint32_t length);
+FILEIO_FREE_EXTENT * FILEIO_FreeExtentSelect (FILEIO_DRIVE * drive, uint32_t count);
+void FILEIO_FreeExtentUpdate (FILEIO_DRIVE * drive, uint32_t cluster, bool allocated);
 uint32_t FILEIO_CreateFirstCluster (FILEIO_OBJECT * filePtr);
 FILEIO_ERROR_TYPE FILEIO_FindShortFileName (FILEIO_DIRECTORY * directory, FILEIO_OBJECT * filePtr, uint8_t * fileName, uint32_t * currentCluster, uint16_t * currentClusterOffset, uint16_t entryOffset, uint16_t attributes, FILEIO_SEARCH_TYPE mode);
 FILEIO_ERROR_TYPE FILEIO_EraseFile (FILEIO_OBJECT * filePtr, uint16_t * entryHandle, bool eraseData);
+FILEIO_ERROR_TYPE FILEIO_FileRemove (const char * pathName, FILEIO_OBJECT * filePtr, bool eraseData);
 FILEIO_ERROR_TYPE FILEIO_DirectoryEntryFindEmpty (FILEIO_OBJECT * filePtr, uint16_t * entryOffset);
+#if defined (FILEIO_CONFIG_FREE_ENTRY_HINT_SIZE)
+FILEIO_FREE_ENTRY_HINT * FILEIO_FreeEntryHintGet (FILEIO_DIRECTORY * directory);
+void FILEIO_FreeEntryHintRelease (FILEIO_DRIVE * drive, uint32_t cluster, uint16_t entry, uint16_t count);
+void FILEIO_FreeEntryHintDrop (FILEIO_DRIVE * drive, uint32_t cluster);
+void FILEIO_FreeEntryHintDriveDrop (FILEIO_DRIVE * drive);
+#endif
 FILEIO_ERROR_TYPE FILEIO_DirectoryEntryPopulate(FILEIO_OBJECT * filePtr, uint16_t * entryHandle, uint8_t attributes, uint32_t cluster);
 FILEIO_ERROR_TYPE FILEIO_NextClusterGet (FILEIO_OBJECT * fo, uint32_t count);
+FILEIO_ERROR_TYPE FILEIO_FileClusterGet (FILEIO_OBJECT * filePtr, uint32_t index);
+FILEIO_ERROR_TYPE FILEIO_FileClusterNext (FILEIO_OBJECT * filePtr, uint32_t index);
+void FILEIO_ExtentMapAdd (FILEIO_OBJECT * filePtr, uint32_t index, uint32_t cluster);
 int FILEIO_DotEntryWrite (FILEIO_DRIVE * drive, uint32_t dot, uint32_t dotdot, FILEIO_TIMESTAMP * timeStamp);
 void FILEIO_ShortFileNameConvert (char * newFileName, char * oldFileName);
 bool FILEIO_IsClusterAllocated(FILEIO_DIRECTORY * directory, FILEIO_OBJECT * filePtr);
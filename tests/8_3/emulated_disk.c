@@ -28,6 +28,8 @@ const FILEIO_DRIVE_CONFIG EmulatedDisk =
     (FILEIO_DRIVER_SectorRead)EmulatedDiskSectorRead,                     // Function to read a sector from the media.
     (FILEIO_DRIVER_SectorWrite)EmulatedDiskSectorWrite,                   // Function to write a sector to the media.
     (FILEIO_DRIVER_WriteProtectStateGet)EmuldatedDiskWriteProtectStateGet,    // Function to determine if the media is write-protected.
+    (FILEIO_DRIVER_SectorReadMulti)EmulatedDiskSectorReadMulti,           // Function to read consecutive sectors from the media.
+    (FILEIO_DRIVER_SectorWriteMulti)EmulatedDiskSectorWriteMulti,         // Function to write consecutive sectors to the media.
 };
 
 static FILEIO_MEDIA_INFORMATION media_info;
@@ -197,3 +199,29 @@ bool EmulatedDiskSectorRead(void * mediaConfig, uint32_t lba, uint8_t* data){
     
     return true;
 }
+
+bool EmulatedDiskSectorReadMulti(void * mediaConfig, uint32_t lba, uint32_t count, uint8_t* data){
+    if(current_disk == NULL){ return false; }
+
+    for( ; count != 0; count--, lba++, data += current_disk->sector_size){
+        if(EmulatedDiskSectorRead(mediaConfig, lba, data) == false){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EmulatedDiskSectorWriteMulti(void * mediaConfig, uint32_t lba, uint32_t count, uint8_t* data){
+    if(current_disk == NULL){ return false; }
+
+    if(lba == 0){ return false; }
+
+    for( ; count != 0; count--, lba++, data += current_disk->sector_size){
+        if(EmulatedDiskSectorWrite(mediaConfig, lba, data, false) == false){
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -48,6 +48,8 @@ extern bool EmulatedDiskMediaDetect(void * mediaConfig);
 extern FILEIO_MEDIA_INFORMATION *EmulatedDiskMediaInitialize(void * mediaConfig);
 extern bool EmulatedDiskMediaDeinitialize(void * mediaConfig);
 extern bool EmulatedDiskSectorRead(void * mediaConfig, uint32_t sector_addr, uint8_t* buffer);
+extern bool EmulatedDiskSectorReadMulti(void * mediaConfig, uint32_t sector_addr, uint32_t count, uint8_t* buffer);
+extern bool EmulatedDiskSectorWriteMulti(void * mediaConfig, uint32_t sector_addr, uint32_t count, uint8_t* buffer);
 
 #endif /* EMULATED_DISK_H */
 
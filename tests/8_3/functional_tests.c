@@ -295,6 +295,36 @@ bool Rename(void){
     return true;
 }
 
+bool CreateFileInOtherDirectory(void){ 
+    const char name[] = "CreateFileInOtherDirectory";
+    char fileName[] = "F00.TXT";
+    FILEIO_OBJECT myFile;
+    FILEIO_SEARCH_RECORD searchRecord;
+    char data[4];
+    int i;
+    
+    // Move the working directory's last entry offset past the end of the new directory
+    for(i = 0; i < 20; i++){
+        fileName[1] = '0' + (i / 10);
+        fileName[2] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    }
+    if(FILEIO_DirectoryMake("SUB") != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, "SUB/A.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write("DATA", 1, 4, &myFile) != 4) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_Open(&myFile, "SUB/A.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "DATA", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    // Searches stop at the directory's first empty entry, so the new entry must come before it
+    if(FILEIO_DirectoryChange("SUB") != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Find ("*.TXT", FILEIO_ATTRIBUTE_MASK, &searchRecord, true) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_DirectoryChange("..") != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
 bool FindFilesInRoot(void){ 
     const char name[] = "FindFilesInRoot";
     FILEIO_OBJECT myFile;
@@ -315,6 +345,959 @@ bool FindFilesInRoot(void){
     return true;
 }
 
+bool InterleavedWrites(void){ 
+    const char name[] = "InterleavedWrites";
+    FILEIO_OBJECT myFile;
+    FILEIO_OBJECT myFile2;
+    uint8_t buffer[100];
+    uint8_t buffer2[100];
+    int i, j;
+    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, "TEST2.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 30; i++){
+        for(j = 0; j < sizeof(buffer); j++){buffer[j] = (uint8_t)(i + j); buffer2[j] = (uint8_t)(i * j);}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer2, 1, sizeof(buffer2), &myFile2) != sizeof(buffer2)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, "TEST2.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 30; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Read(buffer2, 1, sizeof(buffer2), &myFile2) != sizeof(buffer2)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if((buffer[j] != (uint8_t)(i + j)) || (buffer2[j] != (uint8_t)(i * j))) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    
+    return true;
+}
+
+uint32_t FreeClustersGet(void){
+    FILEIO_DRIVE_PROPERTIES properties;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    if(properties.properties_status != FILEIO_GET_PROPERTIES_NO_ERRORS) {return 0;}
+    
+    return properties.results.free_clusters;
+}
+
+bool RemoveReleasesClusters(void){ 
+    const char name[] = "RemoveReleasesClusters";
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[100];
+    uint32_t freeClusters;
+    int i;
+    
+    memset(buffer, 0x5A, sizeof(buffer));
+    freeClusters = FreeClustersGet();
+    if(freeClusters == 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, "TEST3.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 50; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() >= freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove("TEST3.TXT") != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool SeekWithExtentMap(void){ 
+    const char name[] = "SeekWithExtentMap";
+    const int32_t offsets[] = {55000, 100, 99999, 16384, 70000, 0, 32767};
+    FILEIO_OBJECT myFile;
+    FILEIO_OBJECT myFile2;
+    FILEIO_EXTENT extents[2];
+    uint8_t buffer[250];
+    int i, j;
+    
+    // Interleave the writes so the clusters of the file are not contiguous
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, "TEST2.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    for(i = 0; i < 400; i++){
+        for(j = 0; j < sizeof(buffer); j++){buffer[j] = (uint8_t)((i * sizeof(buffer) + j) % 251);}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    for(i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++){
+        if(FILEIO_Seek(&myFile, offsets[i], FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != ((offsets[i] > 99750) ? 100000 - offsets[i] : sizeof(buffer))) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(buffer[0] != (uint8_t)(offsets[i] % 251)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 100000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool OverwriteWholeSectors(void){ 
+    const char name[] = "OverwriteWholeSectors";
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[1024];
+    uint8_t expected;
+    int i;
+    
+    memset(buffer, 0x11, sizeof(buffer));
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 300, &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Overwrite the second sector completely and the start of the third sector
+    memset(buffer, 0x22, sizeof(buffer));
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 512, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 600, &myFile) != 600) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        expected = ((i >= 512) && (i < 1112)) ? 0x22 : 0x11;
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 300; i++){
+        expected = (i < 88) ? 0x22 : 0x11;
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool ReadWholeSectors(void){ 
+    const char name[] = "ReadWholeSectors";
+    static uint8_t buffer[40000];
+    FILEIO_OBJECT myFile;
+    int i;
+    
+    for(i = 0; i < sizeof(buffer); i++){buffer[i] = (uint8_t)(i % 253);}
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i += 1000){
+        if(FILEIO_Write(buffer + i, 1, 1000, &myFile) != 1000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    // Read back the data before it is flushed, some of it from the cache
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        if(buffer[i] != (uint8_t)(i % 253)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Unaligned start, then whole sectors, then a partial sector at the end of the file
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 1000, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer) - 1000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer) - 1000; i++){
+        if(buffer[i] != (uint8_t)((i + 1000) % 253)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool WriteWholeSectors(void){ 
+    const char name[] = "WriteWholeSectors";
+    static uint8_t buffer[40000];
+    FILEIO_OBJECT myFile;
+    uint8_t expected;
+    int i;
+    
+    for(i = 0; i < sizeof(buffer); i++){buffer[i] = (uint8_t)(i % 251);}
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 300, &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer + 300, 1, sizeof(buffer) - 300, &myFile) != sizeof(buffer) - 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Dirty a cached sector, then overwrite it with whole sectors before it is flushed
+    memset(buffer, 0x33, 100);
+    if(FILEIO_Seek(&myFile, 600, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 100, &myFile) != 100) {printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x44, 2048);
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 2048, &myFile) != 2048) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 2048) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        expected = (i < 2048) ? 0x44 : (uint8_t)(i % 251);
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool PreallocateContiguous(void){ 
+    const char name[] = "PreallocateContiguous";
+    FILEIO_OBJECT myFile;
+    FILEIO_EXTENT extents[2];
+    uint8_t buffer[1000];
+    uint32_t freeClusters, preallocated;
+    int i;
+    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Preallocate(&myFile, 100000, FILEIO_PREALLOCATE_CONTIGUOUS) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    preallocated = freeClusters - FreeClustersGet();
+    if(preallocated == 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The new clusters form one run, which may or may not follow the first cluster
+    if((myFile.extentCount == 0) || (extents[myFile.extentCount - 1].fileCluster + extents[myFile.extentCount - 1].length != preallocated + 1)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.extentCount == 2) && (extents[1].length != preallocated)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The size doesn't change, and writing the data allocates nothing more
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 100; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Flush(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - preallocated) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Extending the size makes the reservation part of the file
+    if(FILEIO_Preallocate(&myFile, 150000, FILEIO_PREALLOCATE_EXTEND_SIZE) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, "TEST.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 150000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 99000, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        if(buffer[i] != 99) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool AllocationPolicyRuns(void){ 
+    const char name[] = "AllocationPolicyRuns";
+    FILEIO_OBJECT myFile1, myFile2;
+    FILEIO_EXTENT extents1[8], extents2[8];
+    uint8_t buffer[4096];
+    int i, j;
+    
+    if(FILEIO_AllocationPolicySet('A', (FILEIO_ALLOCATION_POLICY)7) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_BEST_FIT_RUN) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile1, "TEST1.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, "TEST2.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    // Grow both files at the same time; each should stay in its own run instead of interleaving with the other
+    for(i = 0; i < 64; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        memset(buffer, (uint8_t)(i + 0x80), sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_NEXT_FIT) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile1, "TEST1.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, "TEST2.TXT", FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile1, extents1, 8);
+    FILEIO_ExtentMapSet(&myFile2, extents2, 8);
+    // Seeking to the end maps the files' cluster chains
+    if(FILEIO_Seek(&myFile1, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile2, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile1.extentCount > 3) || (myFile2.extentCount > 3)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile1, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile2, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 64; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != i) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != i + 0x80) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool AllocationWindowAppend(void){ 
+    const char name[] = "AllocationWindowAppend";
+    char testFileName[] = "LOG0.TXT";
+    FILEIO_OBJECT myFiles[4];
+    FILEIO_EXTENT extents[8];
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j, k;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    for(i = 0; i < 4; i++){
+        testFileName[3] = '1' + i;
+        if(FILEIO_Open(&myFiles[i], testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    freeClusters = FreeClustersGet();
+    // Append to the files in turn
+    for(i = 0; i < 16; i++){
+        for(j = 0; j < 4; j++){
+            memset(buffer, (uint8_t)(i + (j << 4)), sizeof(buffer));
+            if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFiles[j]) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    // Closing the files frees the clusters they didn't grow into
+    for(j = 0; j < 4; j++){
+        if(FILEIO_Close(&myFiles[j]) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    if(FreeClustersGet() != freeClusters - 4 * (((16 * sizeof(buffer) + clusterSize - 1) / clusterSize) - 1)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Each file grew in its own run after its first cluster, unless a cluster already in use cut the run short
+    for(j = 0; j < 4; j++){
+        testFileName[3] = '1' + j;
+        if(FILEIO_Open(&myFiles[j], testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        FILEIO_ExtentMapSet(&myFiles[j], extents, 8);
+        if(FILEIO_Seek(&myFiles[j], 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Tell(&myFiles[j]) != 16 * sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(myFiles[j].extentCount > 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Seek(&myFiles[j], 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < 16; i++){
+            if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFiles[j]) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+            for(k = 0; k < sizeof(buffer); k++){
+                if(buffer[k] != (uint8_t)(i + (j << 4))) {printf("TEST FAILED: %s\r\n", name); return false;}
+            }
+        }
+        if(FILEIO_Close(&myFiles[j]) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    
+    return true;
+}
+
+// Returns true if every copy of the FAT on the test drive matches the first one.  If update is true, the first copy is
+// written over the others instead.
+bool FATCopiesMatch(bool update){
+    uint8_t sector[512], copy[512];
+    uint32_t base = 0, fatSize, i;
+    uint8_t fatCount, j;
+    
+    if(EmulatedDiskSectorRead(NULL, 0, sector) == false) {return false;}
+    if((sector[0] != 0xEB) && (sector[0] != 0xE9)){
+        // Partitioned media; the boot sector is at the start of the first partition
+        base = sector[0x1C6] | (sector[0x1C7] << 8) | ((uint32_t)sector[0x1C8] << 16) | ((uint32_t)sector[0x1C9] << 24);
+        if(EmulatedDiskSectorRead(NULL, base, sector) == false) {return false;}
+    }
+    fatCount = sector[0x10];
+    fatSize = sector[0x16] | (sector[0x17] << 8);
+    if(fatSize == 0){
+        fatSize = sector[0x24] | (sector[0x25] << 8) | ((uint32_t)sector[0x26] << 16) | ((uint32_t)sector[0x27] << 24);
+    }
+    base += sector[0x0E] | (sector[0x0F] << 8);
+    
+    for(i = 0; i < fatSize; i++){
+        if(EmulatedDiskSectorRead(NULL, base + i, sector) == false) {return false;}
+        for(j = 1; j < fatCount; j++){
+            if(update){
+                if(EmulatedDiskSectorWrite(NULL, base + (j * fatSize) + i, sector, false) == false) {return false;}
+            } else {
+                if(EmulatedDiskSectorRead(NULL, base + (j * fatSize) + i, copy) == false) {return false;}
+                if(memcmp(sector, copy, sizeof(sector)) != 0) {return false;}
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool DeferredFATMirroring(void){ 
+    const char name[] = "DeferredFATMirroring";
+    const char testFileName[] = "MIRROR.TXT";
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[4096];
+    int i;
+    
+    if(FILEIO_FATMirroringSet('A', (FILEIO_FAT_MIRRORING)2) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    // The test image doesn't mirror its FAT to begin with
+    if(FATCopiesMatch(true) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_FATMirroringSet('A', FILEIO_FAT_MIRRORING_DEFERRED) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 16; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    // The secondary FAT copies are brought up to date at each sync point
+    if(FILEIO_Sync('A') != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 16; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_FATMirroringSet('A', FILEIO_FAT_MIRRORING_IMMEDIATE) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RemoveFragmentedFile(void){ 
+    const char name[] = "RemoveFragmentedFile";
+    const char testFileName1[] = "FRAG1.TXT";
+    const char testFileName2[] = "FRAG2.TXT";
+    FILEIO_OBJECT myFile1, myFile2;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile1, testFileName1, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    // Growing both files at once interleaves their cluster chains
+    for(i = 0; i < 192; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Removing one file frees exactly its clusters and leaves the other file intact
+    if(FILEIO_Remove(testFileName1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - ((192 * sizeof(buffer) + clusterSize - 1) / clusterSize)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 192; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != (uint8_t)i) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RemoveIncremental(void){ 
+    const char name[] = "RemoveIncremental";
+    const char testFileName[] = "BIG.TXT";
+    FILEIO_OBJECT myFile;
+    FILEIO_REMOVE_STATE removeState;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize, fileClusters;
+    int i;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    fileClusters = (160 * sizeof(buffer) + clusterSize - 1) / clusterSize;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x5A, sizeof(buffer));
+    for(i = 0; i < 160; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A budget of 0 is rejected before anything is removed
+    removeState.new_request = true;
+    if(FILEIO_RemoveIncremental(testFileName, &removeState, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.new_request != true) || (FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    if(FreeClustersGet() != freeClusters - fileClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The first call removes the directory entry and frees no more clusters than the budget
+    removeState.new_request = true;
+    if(FILEIO_RemoveIncremental(testFileName, &removeState, 3) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.status != FILEIO_REMOVE_STILL_WORKING) || (removeState.clusters_freed != 3)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - fileClusters + 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    // A budget of 0 leaves a removal in progress as it is
+    if(FILEIO_RemoveIncremental(NULL, &removeState, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.status != FILEIO_REMOVE_STILL_WORKING) || (removeState.clusters_freed != 3) || (FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    for(i = 0; (i < 100) && (removeState.status == FILEIO_REMOVE_STILL_WORKING); i++){
+        if(FILEIO_RemoveIncremental(NULL, &removeState, 3) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if((removeState.status != FILEIO_REMOVE_COMPLETE) || (removeState.clusters_freed != fileClusters)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // A completed removal can't be continued, and stays complete
+    if(FILEIO_RemoveIncremental(NULL, &removeState, 3) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(removeState.status != FILEIO_REMOVE_COMPLETE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool TruncateFile(void){ 
+    const char name[] = "TruncateFile";
+    const char testFileName[] = "TRUNC.TXT";
+    FILEIO_OBJECT myFile;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 64; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Truncate(&myFile, 64 * sizeof(buffer) + 1) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Only the clusters past the new end of the file are freed, and the position moves back to the new end
+    if(FILEIO_Truncate(&myFile, 5 * clusterSize + 100) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - 6) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 5 * clusterSize + 100) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Cutting the file on a cluster boundary leaves it ready to grow again
+    if(FILEIO_Truncate(&myFile, 2 * clusterSize) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0xEE, sizeof(buffer));
+    if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() != freeClusters - 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(myFile.size != 2 * clusterSize + sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < (2 * clusterSize) / sizeof(buffer) + 1; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != ((i < (2 * clusterSize) / sizeof(buffer)) ? (uint8_t)i : 0xEE)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Truncate(&myFile, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RewriteFile(void){ 
+    const char name[] = "RewriteFile";
+    const char testFileName[] = "REWRITE.TXT";
+    FILEIO_OBJECT myFile;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize, firstCluster;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x11, sizeof(buffer));
+    for(i = 0; i < 64; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A rewrite needs write access
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ | FILEIO_OPEN_REWRITE) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    // The new contents are written over the old chain without freeing or allocating clusters
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_REWRITE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(myFile.size != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    firstCluster = myFile.firstCluster;
+    memset(buffer, 0x22, sizeof(buffer));
+    for(i = 0; i < 20; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FreeClustersGet() != freeClusters - (64 * sizeof(buffer) + clusterSize - 1) / clusterSize) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The part of the old chain that wasn't reused is freed on close
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() != freeClusters - (20 * sizeof(buffer) + clusterSize - 1) / clusterSize) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.size != 20 * sizeof(buffer)) || (myFile.firstCluster != firstCluster)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 20; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != 0x22) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool DirectoryIndexLookups(void){ 
+    const char name[] = "DirectoryIndexLookups";
+    const char testDirName[] = "INDEX";
+    const char testDirUpName[] = "..";
+    const char renamedShortName[] = "RENAMED.TXT";
+    const char movedShortName[] = "MOVED.TXT";
+    const char oldDirFileName[] = "OLD/A.TXT";
+    const char newDirFileName[] = "NEW/A.TXT";
+    const char oldDirName[] = "OLD";
+    const char newDirName[] = "NEW";
+    char fileName[] = "LOG00.TXT";
+    FILEIO_OBJECT myFile;
+    char data[2];
+    int i;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Files created after the directory was indexed are found through the index
+    for(i = 0; i < 20; i++){
+        fileName[3] = data[0] = '0' + (i / 10);
+        fileName[4] = data[1] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(data, 1, 2, &myFile) != 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // Removed and renamed files are dropped from the index
+    fileName[3] = '0'; fileName[4] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[4] = '6';
+    if(FILEIO_Rename(fileName, renamedShortName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Rename(renamedShortName, movedShortName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, renamedShortName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedShortName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 2, &myFile) != 2) || (data[0] != '0') || (data[1] != '6')) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // More names than the index can hold; the directory is then searched directly
+    for(i = 20; i < 80; i++){
+        fileName[3] = data[0] = '0' + (i / 10);
+        fileName[4] = data[1] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(data, 1, 2, &myFile) != 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    for(i = 0; i < 80; i++){
+        fileName[3] = '0' + (i / 10);
+        fileName[4] = '0' + (i % 10);
+        if((i == 5) || (i == 6)){
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+            continue;
+        }
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if((FILEIO_Read(data, 1, 2, &myFile) != 2) || (data[0] != fileName[3]) || (data[1] != fileName[4])) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // A removed directory's index isn't used for a new directory in the same place
+    if(FILEIO_DirectoryMake(oldDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, oldDirFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, oldDirFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryRemove(oldDirName) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(oldDirFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(oldDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(newDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, newDirFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool PathCacheLookups(void){ 
+    const char name[] = "PathCacheLookups";
+    const char deepDirName[] = "CACHE/LOGS/2026";
+    const char deepFileName[] = "CACHE/LOGS/2026/A.TXT";
+    const char logsDirName[] = "CACHE/LOGS";
+    const char oldLogsName[] = "OLDLOGS";
+    const char movedDirName[] = "CACHE/OLDLOGS/2026";
+    const char movedFileName[] = "CACHE/OLDLOGS/2026/A.TXT";
+    FILEIO_OBJECT myFile;
+    char data[1];
+    int i;
+    
+    if(FILEIO_DirectoryMake(deepDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_PutChar('a', &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Repeated opens under the same directories
+    for(i = 0; i < 3; i++){
+        if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if((FILEIO_Read(data, 1, 1, &myFile) != 1) || (data[0] != 'a')) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // A renamed directory can't be found by its old name
+    if(FILEIO_Rename(logsDirName, oldLogsName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A removed directory can't be found, even if a new directory with the same name is made
+    if(FILEIO_Remove(movedFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(movedDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(movedDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool FreeEntryReuse(void){ 
+    const char name[] = "FreeEntryReuse";
+    const char testDirName[] = "FREE";
+    const char testDirUpName[] = "..";
+    const char searchName[] = "*.*";
+    // The order the files should be in the directory after each file is created in the first free entry
+    const char expected[] = "00 01 02 03 04 XX 06 07 08 09 YY 11 12 13 14 15 16 17 18 ZZ ";
+    char fileName[] = "ENTRY00.TXT";
+    char order[64];
+    FILEIO_OBJECT myFile;
+    FILEIO_SEARCH_RECORD searchRecord;
+    int i, result;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 20; i++){
+        fileName[5] = '0' + (i / 10);
+        fileName[6] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // Removed files' entries are used by the next files created, earliest first
+    fileName[5] = '1'; fileName[6] = '0';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[5] = '0'; fileName[6] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[5] = fileName[6] = 'X';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    fileName[5] = fileName[6] = 'Y';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Removing the last file moves the end of the directory back
+    fileName[5] = '1'; fileName[6] = '9';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[5] = fileName[6] = 'Z';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // List the files in directory order
+    order[0] = 0;
+    result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, true);
+    while((result == FILEIO_RESULT_SUCCESS) && (strlen(order) < sizeof(order) - 4)){
+        sprintf(order + strlen(order), "%c%c ", searchRecord.shortFileName[5], searchRecord.shortFileName[6]);
+        result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, false);
+    }
+    if(strcmp(order, expected) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool DirectoryReadBatches(void){ 
+    const char name[] = "DirectoryReadBatches";
+    const char testDirName[] = "READ";
+    const char testDirUpName[] = "..";
+    const char currentDirName[] = ".";
+    // Each file's name in directory order
+    const char expectedAll[] = ". .. DATA.TXT SHORT.TXT SUBDIR BATCH00.LOG BATCH01.LOG BATCH02.LOG BATCH04.LOG BATCH05.LOG BATCH06.LOG BATCH07.LOG BATCH08.LOG BATCH09.LOG ";
+    const char expectedFiles[] = "DATA.TXT SHORT.TXT BATCH00.LOG BATCH01.LOG BATCH02.LOG BATCH04.LOG BATCH05.LOG BATCH06.LOG BATCH07.LOG BATCH08.LOG BATCH09.LOG ";
+    const char data[] = "0123456789";
+    char fileName[] = "BATCH00.LOG";
+    static FILEIO_DIRECTORY_RECORD records[4];
+    static char order[256];
+    FILEIO_OBJECT myFile;
+    FILEIO_DIRECTORY_OBJECT directory;
+    int i, result;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, "DATA.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(data, 1, 10, &myFile) != 10) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, "SHORT.TXT", FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryMake("SUBDIR") != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 10; i++){
+        fileName[6] = '0' + i;
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    fileName[6] = '3';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+
+    // Read the whole directory a few records at a time
+    if(FILEIO_DirectoryOpen(&directory, testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    order[0] = 0;
+    do{
+        result = FILEIO_DirectoryRead(&directory, records, 4, FILEIO_ATTRIBUTE_MASK);
+        if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < result; i++){
+            strcat(order, (char *)records[i].shortFileName);
+            strcat(order, " ");
+            if(strcmp((char *)records[i].shortFileName, "DATA.TXT") == 0){
+                if((records[i].fileSize != 10) || (records[i].firstCluster == 0) || ((records[i].attributes & FILEIO_ATTRIBUTE_DIRECTORY) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+            }
+        }
+    }while(result == 4);
+    if(strcmp(order, expectedAll) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The end of the directory stays the end
+    if(FILEIO_DirectoryRead(&directory, records, 4, FILEIO_ATTRIBUTE_MASK) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+
+    // Only return files
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryOpen(&directory, currentDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    order[0] = 0;
+    do{
+        result = FILEIO_DirectoryRead(&directory, records, 3, FILEIO_ATTRIBUTE_ARCHIVE);
+        if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < result; i++){
+            strcat(order, (char *)records[i].shortFileName);
+            strcat(order, " ");
+        }
+    }while(result == 3);
+    if(strcmp(order, expectedFiles) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+bool DirectoryChainMap(void){ 
+    const char name[] = "DirectoryChainMap";
+    const char testDirName[] = "CHAIN";
+    const char testDirUpName[] = "..";
+    const char fillName[] = "CHAINFIL.BIN";
+    char fileName[] = "CH0000.TXT";
+    static char fill[128];
+    static FILEIO_DIRECTORY_RECORD records[8];
+    FILEIO_OBJECT myFile, fillFile;
+    FILEIO_DIRECTORY_OBJECT directory;
+    int i, pass, result, count;
+    char data;
+    
+    if(FILEIO_Open(&fillFile, fillName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(pass = 0; pass < 2; pass++){
+        if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Grow another file while the directory grows, so the directory's clusters aren't contiguous
+        for(i = 0; i < 600; i++){
+            fileName[2] = '0' + (i / 1000);
+            fileName[3] = '0' + ((i / 100) % 10);
+            fileName[4] = '0' + ((i / 10) % 10);
+            fileName[5] = '0' + (i % 10);
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_PutChar((char)(i + pass), &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+            if(FILEIO_Write(fill, 1, sizeof(fill), &fillFile) != sizeof(fill)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        // Open the files from the end of the directory back to the start
+        for(i = 599; i >= 0; i--){
+            fileName[2] = '0' + (i / 1000);
+            fileName[3] = '0' + ((i / 100) % 10);
+            fileName[4] = '0' + ((i / 10) % 10);
+            fileName[5] = '0' + (i % 10);
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if((FILEIO_Read(&data, 1, 1, &myFile) != 1) || (data != (char)(i + pass))) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+        }
+        if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryOpen(&directory, testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        count = 0;
+        do{
+            result = FILEIO_DirectoryRead(&directory, records, 8, FILEIO_ATTRIBUTE_ARCHIVE);
+            if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+            count += result;
+        }while(result == 8);
+        if(count != 600) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Remove the directory; the next pass makes it again, possibly in the same clusters
+        if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < 600; i++){
+            fileName[2] = '0' + (i / 1000);
+            fileName[3] = '0' + ((i / 100) % 10);
+            fileName[4] = '0' + ((i / 10) % 10);
+            fileName[5] = '0' + (i % 10);
+            if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryRemove(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Reuse the lowest free clusters, so the new directory starts where the old one did
+        if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_FIRST_FIT_RUN) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_NEXT_FIT) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&fillFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(fillName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+bool WorkingDirectoryPath(void){ 
+    const char name[] = "WorkingDirectoryPath";
+    const char outerDirName[] = "OUTER";
+    const char innerPath[] = "OUTER/INNER";
+    const char shortPath[] = "OUTER/SHORT";
+    const char renamedPath[] = "OUTER/RENAMED";
+    const char siblingPath[] = "../SHORT";
+    const char absolutePath[] = "A:/OUTER//INNER/";
+    const char renamedName[] = "RENAMED";
+    const char upPath[] = "../..";
+    const char dotName[] = ".";
+    const char rootPath[] = "A:";
+    // The path after each step
+    const char * expected[] = {"A:", "A:/OUTER/INNER", "A:/OUTER/INNER", "A:/OUTER/SHORT", "A:", "A:/OUTER/INNER", "A:/OUTER/SHORT", "A:/OUTER/RENAMED", "A:"};
+    char path[40];
+    int i, step, length;
+    
+    if(FILEIO_DirectoryMake(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(shortPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(step = 0; step < 9; step++){
+        switch(step){
+            case 1: i = FILEIO_DirectoryChange(innerPath); break;
+            case 2: i = FILEIO_DirectoryChange(dotName); break;
+            case 3: i = FILEIO_DirectoryChange(siblingPath); break;
+            case 4: i = FILEIO_DirectoryChange(upPath); break;
+            case 5: i = FILEIO_DirectoryChange(absolutePath); break;
+            case 6: i = FILEIO_DirectoryChange(siblingPath); break;
+            // Renaming a directory in the path changes the path
+            case 7: i = FILEIO_Rename(siblingPath, renamedName); break;
+            case 8: i = FILEIO_DirectoryChange(rootPath); break;
+            default: i = FILEIO_RESULT_SUCCESS; break;
+        }
+        if(i != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Check each path twice, since the second call may use what the first one found
+        for(i = 0; i < 2; i++){
+            length = FILEIO_DirectoryGetCurrent(path, 40);
+            if((length != strlen(expected[step])) || (strcmp(path, expected[step]) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    
+    // A short buffer gets the start of the path, and the length of the whole path is returned
+    if(FILEIO_DirectoryChange(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryGetCurrent(path, 8) != 14) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(strcmp(path, "A:/OUTE") != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryGetCurrent(path, 7) != 14) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(strcmp(path, "A:/OUT") != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    if(FILEIO_DirectoryChange(rootPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(renamedPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(outerDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
 typedef bool (*TEST_FUNCTION)(void);
 TEST_FUNCTION tests[]={
     &CreateFileInRoot,
@@ -325,6 +1308,7 @@ TEST_FUNCTION tests[]={
     &SeekEnd, 
     &Tell,
     &Rename,
+    &CreateFileInOtherDirectory,
     &FindFilesInRoot,
     &DirectoryRemoveAfterFileDeleted,
     &DirectoryRemoveWhileNotEmpty,
@@ -335,7 +1319,27 @@ TEST_FUNCTION tests[]={
     &SeekAndWritePastEnd_2,
     &SeekAndWritePastEnd_3,
     &ErrorClear,
-    &CreateMultipleDirectoriesAtOnce
+    &CreateMultipleDirectoriesAtOnce,
+    &InterleavedWrites,
+    &RemoveReleasesClusters,
+    &SeekWithExtentMap,
+    &OverwriteWholeSectors,
+    &ReadWholeSectors,
+    &WriteWholeSectors,
+    &PreallocateContiguous,
+    &AllocationPolicyRuns,
+    &AllocationWindowAppend,
+    &DeferredFATMirroring,
+    &RemoveFragmentedFile,
+    &RemoveIncremental,
+    &TruncateFile,
+    &RewriteFile,
+    &DirectoryIndexLookups,
+    &PathCacheLookups,
+    &FreeEntryReuse,
+    &DirectoryReadBatches,
+    &DirectoryChainMap,
+    &WorkingDirectoryPath
 };
 
 const uint32_t test_count = (sizeof(tests)/sizeof(TEST_FUNCTION));
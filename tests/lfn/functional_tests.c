@@ -328,6 +328,66 @@ bool Rename(void){
     return true;
 }
 
+bool CreateFileInOtherDirectory(void){ 
+    const char name[] = "CreateFileInOtherDirectory";
+    const uint16_t testDirName[] = {'S','U','B',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    const uint16_t subFileName[] = {'S','U','B','/','A','.','T','X','T',0};
+    const uint16_t searchName[] = {'*','.','T','X','T',0};
+    uint16_t fileName[] = {'F','0','0','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_SEARCH_RECORD searchRecord;
+    char data[4];
+    int i;
+    
+    // Move the working directory's last entry offset past the end of the new directory
+    for(i = 0; i < 20; i++){
+        fileName[1] = '0' + (i / 10);
+        fileName[2] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    }
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, subFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write("DATA", 1, 4, &myFile) != 4) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_Open(&myFile, subFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "DATA", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    // Searches stop at the directory's first empty entry, so the new entry must come before it
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Find (searchName, FILEIO_ATTRIBUTE_MASK, &searchRecord, true) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RenameRecreatesEntry(void){ 
+    const char name[] = "RenameRecreatesEntry";
+    const uint16_t testFileName[] = {'R','E','N','L','O','N','G','.','T','X','T',0};
+    const uint16_t longFileName[] = {'A',' ','m','u','c','h',' ','l','o','n','g','e','r',' ','f','i','l','e',' ','n','a','m','e','.','t','x','t',0};
+    const uint16_t shortFileName[] = {'R','E','N','S','H','O','R','T','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    char data[6];
+    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write("RENAME", 1, 6, &myFile) != 6) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    // The new name needs more entries than the old one, so the file's entry is recreated
+    if(FILEIO_Rename(testFileName, longFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_Open(&myFile, longFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.size != 6) || (FILEIO_Read(data, 1, 6, &myFile) != 6) || (memcmp(data, "RENAME", 6) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    // And fewer entries again
+    if(FILEIO_Rename(longFileName, shortFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_Open(&myFile, shortFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.size != 6) || (FILEIO_Read(data, 1, 6, &myFile) != 6) || (memcmp(data, "RENAME", 6) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;} 
+    if(FILEIO_Remove(shortFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
 bool FindFilesInRoot(void){ 
     const char name[] = "FindFilesInRoot";
     const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
@@ -353,6 +413,1167 @@ bool FindFilesInRoot(void){
     return true;
 }
 
+bool InterleavedWrites(void){ 
+    const char name[] = "InterleavedWrites";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    const uint16_t testFile2Name[] = {'T','E','S','T','2','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_OBJECT myFile2;
+    uint8_t buffer[100];
+    uint8_t buffer2[100];
+    int i, j;
+    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFile2Name, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 30; i++){
+        for(j = 0; j < sizeof(buffer); j++){buffer[j] = (uint8_t)(i + j); buffer2[j] = (uint8_t)(i * j);}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer2, 1, sizeof(buffer2), &myFile2) != sizeof(buffer2)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFile2Name, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 30; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Read(buffer2, 1, sizeof(buffer2), &myFile2) != sizeof(buffer2)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if((buffer[j] != (uint8_t)(i + j)) || (buffer2[j] != (uint8_t)(i * j))) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    
+    return true;
+}
+
+uint32_t FreeClustersGet(void){
+    FILEIO_DRIVE_PROPERTIES properties;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    if(properties.properties_status != FILEIO_GET_PROPERTIES_NO_ERRORS) {return 0;}
+    
+    return properties.results.free_clusters;
+}
+
+bool RemoveReleasesClusters(void){ 
+    const char name[] = "RemoveReleasesClusters";
+    const uint16_t testFile3Name[] = {'T','E','S','T','3','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[100];
+    uint32_t freeClusters;
+    int i;
+    
+    memset(buffer, 0x5A, sizeof(buffer));
+    freeClusters = FreeClustersGet();
+    if(freeClusters == 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFile3Name, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 50; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() >= freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(testFile3Name) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool SeekWithExtentMap(void){ 
+    const char name[] = "SeekWithExtentMap";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    const uint16_t testFile2Name[] = {'T','E','S','T','2','.','T','X','T',0};
+    const int32_t offsets[] = {55000, 100, 99999, 16384, 70000, 0, 32767};
+    FILEIO_OBJECT myFile;
+    FILEIO_OBJECT myFile2;
+    FILEIO_EXTENT extents[2];
+    uint8_t buffer[250];
+    int i, j;
+    
+    // Interleave the writes so the clusters of the file are not contiguous
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFile2Name, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    for(i = 0; i < 400; i++){
+        for(j = 0; j < sizeof(buffer); j++){buffer[j] = (uint8_t)((i * sizeof(buffer) + j) % 251);}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    for(i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++){
+        if(FILEIO_Seek(&myFile, offsets[i], FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != ((offsets[i] > 99750) ? 100000 - offsets[i] : sizeof(buffer))) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(buffer[0] != (uint8_t)(offsets[i] % 251)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 100000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool OverwriteWholeSectors(void){ 
+    const char name[] = "OverwriteWholeSectors";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[1024];
+    uint8_t expected;
+    int i;
+    
+    memset(buffer, 0x11, sizeof(buffer));
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 300, &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Overwrite the second sector completely and the start of the third sector
+    memset(buffer, 0x22, sizeof(buffer));
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 512, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 600, &myFile) != 600) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        expected = ((i >= 512) && (i < 1112)) ? 0x22 : 0x11;
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 300; i++){
+        expected = (i < 88) ? 0x22 : 0x11;
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool ReadWholeSectors(void){ 
+    const char name[] = "ReadWholeSectors";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    static uint8_t buffer[40000];
+    FILEIO_OBJECT myFile;
+    int i;
+    
+    for(i = 0; i < sizeof(buffer); i++){buffer[i] = (uint8_t)(i % 253);}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i += 1000){
+        if(FILEIO_Write(buffer + i, 1, 1000, &myFile) != 1000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    // Read back the data before it is flushed, some of it from the cache
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        if(buffer[i] != (uint8_t)(i % 253)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Unaligned start, then whole sectors, then a partial sector at the end of the file
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 1000, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer) - 1000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer) - 1000; i++){
+        if(buffer[i] != (uint8_t)((i + 1000) % 253)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool WriteWholeSectors(void){ 
+    const char name[] = "WriteWholeSectors";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    static uint8_t buffer[40000];
+    FILEIO_OBJECT myFile;
+    uint8_t expected;
+    int i;
+    
+    for(i = 0; i < sizeof(buffer); i++){buffer[i] = (uint8_t)(i % 251);}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 300, &myFile) != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer + 300, 1, sizeof(buffer) - 300, &myFile) != sizeof(buffer) - 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Dirty a cached sector, then overwrite it with whole sectors before it is flushed
+    memset(buffer, 0x33, 100);
+    if(FILEIO_Seek(&myFile, 600, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 100, &myFile) != 100) {printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x44, 2048);
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(buffer, 1, 2048, &myFile) != 2048) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 2048) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    memset(buffer, 0, sizeof(buffer));
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        expected = (i < 2048) ? 0x44 : (uint8_t)(i % 251);
+        if(buffer[i] != expected) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool PreallocateContiguous(void){ 
+    const char name[] = "PreallocateContiguous";
+    const uint16_t testFileName[] = {'T','E','S','T','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_EXTENT extents[2];
+    uint8_t buffer[1000];
+    uint32_t freeClusters, preallocated;
+    int i;
+    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile, extents, 2);
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Preallocate(&myFile, 100000, FILEIO_PREALLOCATE_CONTIGUOUS) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    preallocated = freeClusters - FreeClustersGet();
+    if(preallocated == 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The new clusters form one run, which may or may not follow the first cluster
+    if((myFile.extentCount == 0) || (extents[myFile.extentCount - 1].fileCluster + extents[myFile.extentCount - 1].length != preallocated + 1)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.extentCount == 2) && (extents[1].length != preallocated)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The size doesn't change, and writing the data allocates nothing more
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 100; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Flush(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - preallocated) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Extending the size makes the reservation part of the file
+    if(FILEIO_Preallocate(&myFile, 150000, FILEIO_PREALLOCATE_EXTEND_SIZE) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 150000) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile, 99000, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < sizeof(buffer); i++){
+        if(buffer[i] != 99) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool AllocationPolicyRuns(void){ 
+    const char name[] = "AllocationPolicyRuns";
+    const uint16_t testFileName1[] = {'T','E','S','T','1','.','T','X','T',0};
+    const uint16_t testFileName2[] = {'T','E','S','T','2','.','T','X','T',0};
+    FILEIO_OBJECT myFile1, myFile2;
+    FILEIO_EXTENT extents1[8], extents2[8];
+    uint8_t buffer[4096];
+    int i, j;
+    
+    if(FILEIO_AllocationPolicySet('A', (FILEIO_ALLOCATION_POLICY)7) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_BEST_FIT_RUN) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile1, testFileName1, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    // Grow both files at the same time; each should stay in its own run instead of interleaving with the other
+    for(i = 0; i < 64; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        memset(buffer, (uint8_t)(i + 0x80), sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_NEXT_FIT) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile1, testFileName1, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ExtentMapSet(&myFile1, extents1, 8);
+    FILEIO_ExtentMapSet(&myFile2, extents2, 8);
+    // Seeking to the end maps the files' cluster chains
+    if(FILEIO_Seek(&myFile1, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile2, 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile1.extentCount > 3) || (myFile2.extentCount > 3)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile1, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Seek(&myFile2, 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 64; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != i) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != i + 0x80) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool AllocationWindowAppend(void){ 
+    const char name[] = "AllocationWindowAppend";
+    uint16_t testFileName[] = {'L','O','G','0','.','T','X','T',0};
+    FILEIO_OBJECT myFiles[4];
+    FILEIO_EXTENT extents[8];
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j, k;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    for(i = 0; i < 4; i++){
+        testFileName[3] = '1' + i;
+        if(FILEIO_Open(&myFiles[i], testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    freeClusters = FreeClustersGet();
+    // Append to the files in turn
+    for(i = 0; i < 16; i++){
+        for(j = 0; j < 4; j++){
+            memset(buffer, (uint8_t)(i + (j << 4)), sizeof(buffer));
+            if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFiles[j]) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    // Closing the files frees the clusters they didn't grow into
+    for(j = 0; j < 4; j++){
+        if(FILEIO_Close(&myFiles[j]) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    if(FreeClustersGet() != freeClusters - 4 * (((16 * sizeof(buffer) + clusterSize - 1) / clusterSize) - 1)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Each file grew in its own run after its first cluster, unless a cluster already in use cut the run short
+    for(j = 0; j < 4; j++){
+        testFileName[3] = '1' + j;
+        if(FILEIO_Open(&myFiles[j], testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        FILEIO_ExtentMapSet(&myFiles[j], extents, 8);
+        if(FILEIO_Seek(&myFiles[j], 0, FILEIO_SEEK_END) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Tell(&myFiles[j]) != 16 * sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(myFiles[j].extentCount > 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Seek(&myFiles[j], 0, FILEIO_SEEK_SET) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < 16; i++){
+            if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFiles[j]) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+            for(k = 0; k < sizeof(buffer); k++){
+                if(buffer[k] != (uint8_t)(i + (j << 4))) {printf("TEST FAILED: %s\r\n", name); return false;}
+            }
+        }
+        if(FILEIO_Close(&myFiles[j]) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    
+    return true;
+}
+
+// Returns true if every copy of the FAT on the test drive matches the first one.  If update is true, the first copy is
+// written over the others instead.
+bool FATCopiesMatch(bool update){
+    uint8_t sector[512], copy[512];
+    uint32_t base = 0, fatSize, i;
+    uint8_t fatCount, j;
+    
+    if(EmulatedDiskSectorRead(NULL, 0, sector) == false) {return false;}
+    if((sector[0] != 0xEB) && (sector[0] != 0xE9)){
+        // Partitioned media; the boot sector is at the start of the first partition
+        base = sector[0x1C6] | (sector[0x1C7] << 8) | ((uint32_t)sector[0x1C8] << 16) | ((uint32_t)sector[0x1C9] << 24);
+        if(EmulatedDiskSectorRead(NULL, base, sector) == false) {return false;}
+    }
+    fatCount = sector[0x10];
+    fatSize = sector[0x16] | (sector[0x17] << 8);
+    if(fatSize == 0){
+        fatSize = sector[0x24] | (sector[0x25] << 8) | ((uint32_t)sector[0x26] << 16) | ((uint32_t)sector[0x27] << 24);
+    }
+    base += sector[0x0E] | (sector[0x0F] << 8);
+    
+    for(i = 0; i < fatSize; i++){
+        if(EmulatedDiskSectorRead(NULL, base + i, sector) == false) {return false;}
+        for(j = 1; j < fatCount; j++){
+            if(update){
+                if(EmulatedDiskSectorWrite(NULL, base + (j * fatSize) + i, sector, false) == false) {return false;}
+            } else {
+                if(EmulatedDiskSectorRead(NULL, base + (j * fatSize) + i, copy) == false) {return false;}
+                if(memcmp(sector, copy, sizeof(sector)) != 0) {return false;}
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool DeferredFATMirroring(void){ 
+    const char name[] = "DeferredFATMirroring";
+    const uint16_t testFileName[] = {'M','I','R','R','O','R','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    uint8_t buffer[4096];
+    int i;
+    
+    if(FILEIO_FATMirroringSet('A', (FILEIO_FAT_MIRRORING)2) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    // The test image doesn't mirror its FAT to begin with
+    if(FATCopiesMatch(true) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_FATMirroringSet('A', FILEIO_FAT_MIRRORING_DEFERRED) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 16; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    // The secondary FAT copies are brought up to date at each sync point
+    if(FILEIO_Sync('A') != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 16; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_FATMirroringSet('A', FILEIO_FAT_MIRRORING_IMMEDIATE) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FATCopiesMatch(false) == false) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RemoveFragmentedFile(void){ 
+    const char name[] = "RemoveFragmentedFile";
+    const uint16_t testFileName1[] = {'F','R','A','G','1','.','T','X','T',0};
+    const uint16_t testFileName2[] = {'F','R','A','G','2','.','T','X','T',0};
+    FILEIO_OBJECT myFile1, myFile2;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile1, testFileName1, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    // Growing both files at once interleaves their cluster chains
+    for(i = 0; i < 192; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile1) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Removing one file frees exactly its clusters and leaves the other file intact
+    if(FILEIO_Remove(testFileName1) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - ((192 * sizeof(buffer) + clusterSize - 1) / clusterSize)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile2, testFileName2, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 192; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile2) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != (uint8_t)i) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Close(&myFile2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName2) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RemoveIncremental(void){ 
+    const char name[] = "RemoveIncremental";
+    const uint16_t testFileName[] = {'B','I','G','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_REMOVE_STATE removeState;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize, fileClusters;
+    int i;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    fileClusters = (160 * sizeof(buffer) + clusterSize - 1) / clusterSize;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x5A, sizeof(buffer));
+    for(i = 0; i < 160; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A budget of 0 is rejected before anything is removed
+    removeState.new_request = true;
+    if(FILEIO_RemoveIncremental(testFileName, &removeState, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.new_request != true) || (FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    if(FreeClustersGet() != freeClusters - fileClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The first call removes the directory entry and frees no more clusters than the budget
+    removeState.new_request = true;
+    if(FILEIO_RemoveIncremental(testFileName, &removeState, 3) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.status != FILEIO_REMOVE_STILL_WORKING) || (removeState.clusters_freed != 3)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - fileClusters + 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    // A budget of 0 leaves a removal in progress as it is
+    if(FILEIO_RemoveIncremental(NULL, &removeState, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if((removeState.status != FILEIO_REMOVE_STILL_WORKING) || (removeState.clusters_freed != 3) || (FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    FILEIO_ErrorClear('A');
+    for(i = 0; (i < 100) && (removeState.status == FILEIO_REMOVE_STILL_WORKING); i++){
+        if(FILEIO_RemoveIncremental(NULL, &removeState, 3) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if((removeState.status != FILEIO_REMOVE_COMPLETE) || (removeState.clusters_freed != fileClusters)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // A completed removal can't be continued, and stays complete
+    if(FILEIO_RemoveIncremental(NULL, &removeState, 3) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(removeState.status != FILEIO_REMOVE_COMPLETE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool TruncateFile(void){ 
+    const char name[] = "TruncateFile";
+    const uint16_t testFileName[] = {'T','R','U','N','C','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 64; i++){
+        memset(buffer, (uint8_t)i, sizeof(buffer));
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Truncate(&myFile, 64 * sizeof(buffer) + 1) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Only the clusters past the new end of the file are freed, and the position moves back to the new end
+    if(FILEIO_Truncate(&myFile, 5 * clusterSize + 100) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - 6) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Tell(&myFile) != 5 * clusterSize + 100) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Cutting the file on a cluster boundary leaves it ready to grow again
+    if(FILEIO_Truncate(&myFile, 2 * clusterSize) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters - 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0xEE, sizeof(buffer));
+    if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() != freeClusters - 3) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(myFile.size != 2 * clusterSize + sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < (2 * clusterSize) / sizeof(buffer) + 1; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != ((i < (2 * clusterSize) / sizeof(buffer)) ? (uint8_t)i : 0xEE)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Truncate(&myFile, 0) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool RewriteFile(void){ 
+    const char name[] = "RewriteFile";
+    const uint16_t testFileName[] = {'R','E','W','R','I','T','E','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_DRIVE_PROPERTIES properties;
+    uint8_t buffer[4096];
+    uint32_t freeClusters, clusterSize, firstCluster;
+    int i, j;
+    
+    properties.new_request = true;
+    do{
+        FILEIO_DrivePropertiesGet(&properties, 'A');
+    } while(properties.properties_status == FILEIO_GET_PROPERTIES_STILL_WORKING);
+    clusterSize = (uint32_t)properties.results.sector_size * properties.results.sectors_per_cluster;
+    freeClusters = FreeClustersGet();
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE | FILEIO_OPEN_TRUNCATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    memset(buffer, 0x11, sizeof(buffer));
+    for(i = 0; i < 64; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A rewrite needs write access
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ | FILEIO_OPEN_REWRITE) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_ErrorGet('A') != FILEIO_ERROR_INVALID_ARGUMENT){printf("TEST FAILED: %s\r\n", name); return false;}
+    // The new contents are written over the old chain without freeing or allocating clusters
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_READ | FILEIO_OPEN_REWRITE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(myFile.size != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    firstCluster = myFile.firstCluster;
+    memset(buffer, 0x22, sizeof(buffer));
+    for(i = 0; i < 20; i++){
+        if(FILEIO_Write(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FreeClustersGet() != freeClusters - (64 * sizeof(buffer) + clusterSize - 1) / clusterSize) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The part of the old chain that wasn't reused is freed on close
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FreeClustersGet() != freeClusters - (20 * sizeof(buffer) + clusterSize - 1) / clusterSize) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, testFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((myFile.size != 20 * sizeof(buffer)) || (myFile.firstCluster != firstCluster)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 20; i++){
+        if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != sizeof(buffer)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(j = 0; j < sizeof(buffer); j++){
+            if(buffer[j] != 0x22) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Read(buffer, 1, sizeof(buffer), &myFile) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(testFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FreeClustersGet() != freeClusters) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool DirectoryIndexLookups(void){ 
+    const char name[] = "DirectoryIndexLookups";
+    const uint16_t testDirName[] = {'I','N','D','E','X',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    const uint16_t renamedShortName[] = {'R','E','N','A','M','E','D','.','T','X','T',0};
+    const uint16_t movedShortName[] = {'M','O','V','E','D','.','T','X','T',0};
+    const uint16_t oldDirFileName[] = {'O','L','D','/','A','.','T','X','T',0};
+    const uint16_t newDirFileName[] = {'N','E','W','/','A','.','T','X','T',0};
+    const uint16_t oldDirName[] = {'O','L','D',0};
+    const uint16_t newDirName[] = {'N','E','W',0};
+    uint16_t fileName[] = {'l','o','g','-','0','0','.','t','x','t',0};
+    FILEIO_OBJECT myFile;
+    char data[2];
+    int i;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Files created after the directory was indexed are found through the index
+    for(i = 0; i < 20; i++){
+        fileName[4] = data[0] = '0' + (i / 10);
+        fileName[5] = data[1] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(data, 1, 2, &myFile) != 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // Removed and renamed files are dropped from the index
+    fileName[4] = '0'; fileName[5] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[5] = '6';
+    if(FILEIO_Rename(fileName, renamedShortName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Rename(renamedShortName, movedShortName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, renamedShortName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedShortName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 2, &myFile) != 2) || (data[0] != '0') || (data[1] != '6')) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // More names than the index can hold; the directory is then searched directly
+    for(i = 20; i < 60; i++){
+        fileName[4] = data[0] = '0' + (i / 10);
+        fileName[5] = data[1] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(data, 1, 2, &myFile) != 2) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    for(i = 0; i < 60; i++){
+        fileName[4] = '0' + (i / 10);
+        fileName[5] = '0' + (i % 10);
+        if((i == 5) || (i == 6)){
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+            continue;
+        }
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if((FILEIO_Read(data, 1, 2, &myFile) != 2) || (data[0] != fileName[4]) || (data[1] != fileName[5])) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // A removed directory's index isn't used for a new directory in the same place
+    if(FILEIO_DirectoryMake(oldDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, oldDirFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, oldDirFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryRemove(oldDirName) != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(oldDirFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(oldDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(newDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, newDirFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool PathCacheLookups(void){ 
+    const char name[] = "PathCacheLookups";
+    const uint16_t deepDirName[] = {'C','A','C','H','E','/','l','o','g','s','/','2','0','2','6',0};
+    const uint16_t deepFileName[] = {'C','A','C','H','E','/','l','o','g','s','/','2','0','2','6','/','a','.','t','x','t',0};
+    const uint16_t logsDirName[] = {'C','A','C','H','E','/','l','o','g','s',0};
+    const uint16_t oldLogsName[] = {'o','l','d','-','l','o','g','s',0};
+    const uint16_t movedDirName[] = {'C','A','C','H','E','/','o','l','d','-','l','o','g','s','/','2','0','2','6',0};
+    const uint16_t movedFileName[] = {'C','A','C','H','E','/','o','l','d','-','l','o','g','s','/','2','0','2','6','/','a','.','t','x','t',0};
+    const uint16_t shortDirName[] = {'C','A','C','H','E','/','A','R','C','H','I','V','E',0};
+    const uint16_t shortFileName[] = {'C','A','C','H','E','/','A','R','C','H','I','V','E','/','B','.','T','X','T',0};
+    const uint16_t savedName[] = {'S','A','V','E','D',0};
+    const uint16_t savedFileName[] = {'C','A','C','H','E','/','S','A','V','E','D','/','B','.','T','X','T',0};
+    FILEIO_OBJECT myFile;
+    char data[1];
+    int i;
+    
+    if(FILEIO_DirectoryMake(deepDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_PutChar('a', &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Repeated opens under the same directories
+    for(i = 0; i < 3; i++){
+        if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if((FILEIO_Read(data, 1, 1, &myFile) != 1) || (data[0] != 'a')) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // A renamed directory can't be found by its old name
+    if(FILEIO_Rename(logsDirName, oldLogsName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, deepFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryMake(shortDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, shortFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Rename(shortDirName, savedName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, shortFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, savedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A removed directory can't be found, even if a new directory with the same name is made
+    if(FILEIO_Remove(movedFileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(movedDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(movedDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_READ) != FILEIO_RESULT_FAILURE){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, movedFileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    return true;
+}
+
+bool AliasNumericTails(void){ 
+    const char name[] = "AliasNumericTails";
+    const uint16_t testDirName[] = {'A','L','I','A','S',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    uint16_t fileName[] = {'l','o','g','_','2','0','2','6','-','1','0','-','1','7','_','0','0','0','0','.','c','s','v',0};
+    uint16_t aliasName[] = {'L','O','G','_','2','0','~','1','.','C','S','V',0};
+    const uint16_t alias10Name[] = {'L','O','G','_','2','~','1','0','.','C','S','V',0};
+    const uint16_t alias100Name[] = {'L','O','G','_','~','1','0','0','.','C','S','V',0};
+    FILEIO_OBJECT myFile;
+    char data[4];
+    int i;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // More files with the same alias than one scan of the directory checks for
+    for(i = 0; i < 300; i++){
+        fileName[15] = data[0] = '0' + (i / 1000);
+        fileName[16] = data[1] = '0' + ((i / 100) % 10);
+        fileName[17] = data[2] = '0' + ((i / 10) % 10);
+        fileName[18] = data[3] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Write(data, 1, 4, &myFile) != 4) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    for(i = 0; i < 300; i++){
+        fileName[15] = '0' + (i / 1000);
+        fileName[16] = '0' + ((i / 100) % 10);
+        fileName[17] = '0' + ((i / 10) % 10);
+        fileName[18] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (data[0] != fileName[15]) || (data[1] != fileName[16]) || (data[2] != fileName[17]) || (data[3] != fileName[18])) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // The first file gets the plain alias; the others are numbered in the order they were created, and the tail grows into the name
+    if(FILEIO_Open(&myFile, aliasName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "0001", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, alias10Name, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "0010", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, alias100Name, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "0100", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A removed file's alias is reused
+    aliasName[7] = '5';
+    if(FILEIO_Remove(aliasName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[15] = fileName[16] = fileName[17] = fileName[18] = 'x';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write("xxxx", 1, 4, &myFile) != 4) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, aliasName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(data, 1, 4, &myFile) != 4) || (memcmp(data, "xxxx", 4) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool FreeEntryReuse(void){ 
+    const char name[] = "FreeEntryReuse";
+    const uint16_t testDirName[] = {'F','R','E','E',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    const uint16_t searchName[] = {'*','.','*',0};
+    const uint16_t longName[] = {'e','n','t','r','y','-','l','o','n','g','e','r','-','n','a','m','e','.','t','x','t',0};
+    const uint16_t secondLongName[] = {'e','n','t','r','y','-','s','e','c','o','n','d','-','n','a','m','e','.','t','x','t',0};
+    // The order the files should be in the directory after each file is created in the first free entries
+    const char expected[] = "00 02 03 04 xx 06 07 08 09 lo 12 13 14 se 17 18 yy zz ";
+    uint16_t fileName[] = {'e','n','t','r','y','-','0','0','.','t','x','t',0};
+    uint16_t foundName[32];
+    char order[64];
+    FILEIO_OBJECT myFile;
+    FILEIO_SEARCH_RECORD searchRecord;
+    int i, result;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 20; i++){
+        fileName[6] = '0' + (i / 10);
+        fileName[7] = '0' + (i % 10);
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    // A removed file's entries are used by the next file that fits in them
+    fileName[6] = '0'; fileName[7] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[6] = fileName[7] = 'x';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Adjacent removed files make room for a longer name
+    fileName[6] = '1'; fileName[7] = '0';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[7] = '1';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, longName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // Removing the last file moves the end of the directory back
+    fileName[6] = '1'; fileName[7] = '9';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[6] = fileName[7] = 'y';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    fileName[6] = fileName[7] = 'z';
+    if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // A longer name goes in the first removed files that make room for it, even if there's a shorter gap before them
+    fileName[6] = '0'; fileName[7] = '1';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[6] = '1'; fileName[7] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    fileName[7] = '6';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, secondLongName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    // List the files in directory order
+    order[0] = 0;
+    result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, true);
+    while((result == FILEIO_RESULT_SUCCESS) && (strlen(order) < sizeof(order) - 4)){
+        if(FILEIO_LongFileNameGet(&searchRecord, foundName, 32) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        sprintf(order + strlen(order), "%c%c ", (char)foundName[6], (char)foundName[7]);
+        result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, false);
+    }
+    if(strcmp(order, expected) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
+bool DirectoryReadBatches(void){ 
+    const char name[] = "DirectoryReadBatches";
+    const uint16_t testDirName[] = {'R','E','A','D',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    const uint16_t currentDirName[] = {'.',0};
+    const uint16_t longName[] = {'a','-','f','a','i','r','l','y','-','l','o','n','g','-','n','a','m','e','-','t','h','a','t','-','n','e','e','d','s','-','f','o','u','r','-','e','n','t','r','i','e','s','.','t','x','t',0};
+    const uint16_t shortName[] = {'S','H','O','R','T','.','T','X','T',0};
+    const uint16_t subDirName[] = {'s','u','b','-','d','i','r','e','c','t','o','r','y',0};
+    // Each file's long name, or its short name if it doesn't have one, in directory order
+    const char expectedAll[] = ". .. a-fairly-long-name-that-needs-four-entries.txt SHORT.TXT sub-directory batch-00.log batch-01.log batch-02.log batch-04.log batch-05.log batch-06.log batch-07.log batch-08.log batch-09.log ";
+    const char expectedFiles[] = "a-fairly-long-name-that-needs-four-entries.txt SHORT.TXT batch-00.log batch-01.log batch-02.log batch-04.log batch-05.log batch-06.log batch-07.log batch-08.log batch-09.log ";
+    const char data[] = "0123456789";
+    uint16_t fileName[] = {'b','a','t','c','h','-','0','0','.','l','o','g',0};
+    static FILEIO_DIRECTORY_RECORD records[4];
+    static char order[512];
+    FILEIO_OBJECT myFile;
+    FILEIO_DIRECTORY_OBJECT directory;
+    int i, j, result;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Open(&myFile, longName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Write(data, 1, 10, &myFile) != 10) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, shortName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_DirectoryMake(subDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(i = 0; i < 10; i++){
+        fileName[7] = '0' + i;
+        if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    }
+    fileName[7] = '3';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+
+    // Read the whole directory a few records at a time
+    if(FILEIO_DirectoryOpen(&directory, testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    order[0] = 0;
+    do{
+        result = FILEIO_DirectoryRead(&directory, records, 4, FILEIO_ATTRIBUTE_MASK);
+        if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < result; i++){
+            if(records[i].longFileName[0] == 0){
+                strcat(order, (char *)records[i].shortFileName);
+            }else{
+                for(j = 0; records[i].longFileName[j] != 0; j++){
+                    order[strlen(order) + 1] = 0;
+                    order[strlen(order)] = (char)records[i].longFileName[j];
+                }
+            }
+            strcat(order, " ");
+            if(strcmp((char *)records[i].shortFileName, "A-FAIR~1.TXT") == 0){
+                if((records[i].fileSize != 10) || (records[i].firstCluster == 0) || (records[i].attributes != FILEIO_ATTRIBUTE_ARCHIVE)) {printf("TEST FAILED: %s\r\n", name); return false;}
+            }
+        }
+    }while(result == 4);
+    if(strcmp(order, expectedAll) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // The end of the directory stays the end
+    if(FILEIO_DirectoryRead(&directory, records, 4, FILEIO_ATTRIBUTE_MASK) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+
+    // Only return files
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryOpen(&directory, currentDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    order[0] = 0;
+    do{
+        result = FILEIO_DirectoryRead(&directory, records, 3, FILEIO_ATTRIBUTE_ARCHIVE);
+        if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < result; i++){
+            if(records[i].longFileName[0] == 0){
+                strcat(order, (char *)records[i].shortFileName);
+            }else{
+                for(j = 0; records[i].longFileName[j] != 0; j++){
+                    order[strlen(order) + 1] = 0;
+                    order[strlen(order)] = (char)records[i].longFileName[j];
+                }
+            }
+            strcat(order, " ");
+        }
+    }while(result == 3);
+    if(strcmp(order, expectedFiles) != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+bool DirectoryChainMap(void){ 
+    const char name[] = "DirectoryChainMap";
+    const uint16_t testDirName[] = {'C','H','A','I','N',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    const uint16_t fillName[] = {'C','H','A','I','N','F','I','L','.','B','I','N',0};
+    uint16_t fileName[] = {'c','h','a','i','n','-','m','a','p','-','f','i','l','e','-','w','i','t','h','-','a','-','n','a','m','e','-','f','i','l','l','i','n','g','-','s','i','x','-','e','n','t','r','i','e','s','-','0','0','0','.','t','x','t',0};
+    static char fill[512];
+    static FILEIO_DIRECTORY_RECORD records[8];
+    FILEIO_OBJECT myFile, fillFile;
+    FILEIO_DIRECTORY_OBJECT directory;
+    int i, pass, result, count;
+    char data;
+    
+    if(FILEIO_Open(&fillFile, fillName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    for(pass = 0; pass < 2; pass++){
+        if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Grow another file while the directory grows, so the directory's clusters aren't contiguous
+        for(i = 0; i < 300; i++){
+            fileName[47] = '0' + (i / 100);
+            fileName[48] = '0' + ((i / 10) % 10);
+            fileName[49] = '0' + (i % 10);
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_PutChar((char)(i + pass), &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+            if(FILEIO_Write(fill, 1, sizeof(fill), &fillFile) != sizeof(fill)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        // Open the files from the end of the directory back to the start
+        for(i = 299; i >= 0; i--){
+            fileName[47] = '0' + (i / 100);
+            fileName[48] = '0' + ((i / 10) % 10);
+            fileName[49] = '0' + (i % 10);
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if((FILEIO_Read(&data, 1, 1, &myFile) != 1) || (data != (char)(i + pass))) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+        }
+        if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryOpen(&directory, testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        count = 0;
+        do{
+            result = FILEIO_DirectoryRead(&directory, records, 8, FILEIO_ATTRIBUTE_ARCHIVE);
+            if(result == FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+            count += result;
+        }while(result == 8);
+        if(count != 300) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Remove the directory; the next pass makes it again, possibly in the same clusters
+        if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        for(i = 0; i < 300; i++){
+            fileName[47] = '0' + (i / 100);
+            fileName[48] = '0' + ((i / 10) % 10);
+            fileName[49] = '0' + (i % 10);
+            if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+        if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        if(FILEIO_DirectoryRemove(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Reuse the lowest free clusters, so the new directory starts where the old one did
+        if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_FIRST_FIT_RUN) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    }
+    if(FILEIO_AllocationPolicySet('A', FILEIO_ALLOCATION_NEXT_FIT) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&fillFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Remove(fillName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+bool LongFileNameLookups(void){ 
+    const char name[] = "LongFileNameLookups";
+    const uint16_t testDirName[] = {'L','O','O','K','U','P',0};
+    const uint16_t testDirUpName[] = {'.','.',0};
+    // Two full entries without a terminator, and one character more
+    const uint16_t alphabetName[] = {'a','b','c','d','e','f','g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x','y','z',0};
+    const uint16_t alphabetLongerName[] = {'a','b','c','d','e','f','g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v','w','x','y','z','a',0};
+    uint16_t fileName[] = {'x','-','l','o','o','k','u','p','-','n','a','m','e','-','t','h','a','t','-','s','p','a','n','s','-','s','e','v','e','r','a','l','-','e','n','t','r','i','e','s','-','0','0','.','d','a','t',0};
+    uint16_t searchName[] = {'?','-','l','o','o','k','u','p','-','n','a','m','e','-','t','h','a','t','-','s','p','a','n','s','-','s','e','v','e','r','a','l','-','e','n','t','r','i','e','s','-','1','?','.','d','a','t',0};
+    FILEIO_OBJECT myFile;
+    FILEIO_SEARCH_RECORD searchRecord;
+    int i, j, result, count;
+    char data;
+    
+    if(FILEIO_DirectoryMake(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    // Names that only differ in their first or last characters, spread over several sectors
+    for(j = 0; j < 2; j++){
+        fileName[0] = 'x' + j;
+        for(i = 0; i < 20; i++){
+            fileName[41] = '0' + (i / 10);
+            fileName[42] = '0' + (i % 10);
+            if(FILEIO_Open(&myFile, fileName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_PutChar((char)(i + (j * 20)), &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+        }
+    }
+    if(FILEIO_Open(&myFile, alphabetName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_PutChar('A', &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, alphabetLongerName, FILEIO_OPEN_WRITE | FILEIO_OPEN_CREATE) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_PutChar('L', &myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    fileName[0] = 'x';
+    fileName[41] = '0';
+    fileName[42] = '5';
+    if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    // Each name finds its own file, and the removed one isn't found
+    for(j = 1; j >= 0; j--){
+        fileName[0] = 'x' + j;
+        for(i = 19; i >= 0; i--){
+            fileName[41] = '0' + (i / 10);
+            fileName[42] = '0' + (i % 10);
+            result = FILEIO_Open(&myFile, fileName, FILEIO_OPEN_READ);
+            if((j == 0) && (i == 5)){
+                if(result != FILEIO_RESULT_FAILURE) {printf("TEST FAILED: %s\r\n", name); return false;}
+                continue;
+            }
+            if(result != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+            if((FILEIO_Read(&data, 1, 1, &myFile) != 1) || (data != (char)(i + (j * 20)))) {printf("TEST FAILED: %s\r\n", name); return false;}
+            if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+        }
+    }
+    if(FILEIO_Open(&myFile, alphabetName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(&data, 1, 1, &myFile) != 1) || (data != 'A')) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    if(FILEIO_Open(&myFile, alphabetLongerName, FILEIO_OPEN_READ) != FILEIO_RESULT_SUCCESS){printf("TEST FAILED: %s\r\n", name); return false;}
+    if((FILEIO_Read(&data, 1, 1, &myFile) != 1) || (data != 'L')) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Close(&myFile) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}    
+    
+    // Wildcards still match any character
+    count = 0;
+    result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, true);
+    while(result == FILEIO_RESULT_SUCCESS){
+        count++;
+        result = FILEIO_Find (searchName, FILEIO_ATTRIBUTE_ARCHIVE, &searchRecord, false);
+    }
+    if(count != 20) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    for(j = 0; j < 2; j++){
+        fileName[0] = 'x' + j;
+        for(i = 0; i < 20; i++){
+            if((j == 0) && (i == 5)){
+                continue;
+            }
+            fileName[41] = '0' + (i / 10);
+            fileName[42] = '0' + (i % 10);
+            if(FILEIO_Remove(fileName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    if(FILEIO_Remove(alphabetName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_Remove(alphabetLongerName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryChange(testDirUpName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(testDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+bool WorkingDirectoryPath(void){ 
+    const char name[] = "WorkingDirectoryPath";
+    const uint16_t outerDirName[] = {'o','u','t','e','r',0};
+    const uint16_t innerPath[] = {'o','u','t','e','r','/','i','n','n','e','r','-','d','i','r','e','c','t','o','r','y',0};
+    const uint16_t shortPath[] = {'o','u','t','e','r','/','S','H','O','R','T',0};
+    const uint16_t renamedPath[] = {'o','u','t','e','r','/','R','E','N','A','M','E','D',0};
+    const uint16_t siblingPath[] = {'.','.','/','S','H','O','R','T',0};
+    const uint16_t absolutePath[] = {'A',':','/','o','u','t','e','r','/','/','i','n','n','e','r','-','d','i','r','e','c','t','o','r','y','/',0};
+    const uint16_t renamedName[] = {'R','E','N','A','M','E','D',0};
+    const uint16_t upPath[] = {'.','.','/','.','.',0};
+    const uint16_t dotName[] = {'.',0};
+    const uint16_t rootPath[] = {'A',':',0};
+    // The path after each step
+    const char * expected[] = {"A:", "A:/outer/inner-directory", "A:/outer/inner-directory", "A:/outer/SHORT", "A:", "A:/outer/inner-directory", "A:/outer/SHORT", "A:/outer/RENAMED", "A:"};
+    uint16_t path[40];
+    char text[40];
+    int i, j, step, length;
+    
+    if(FILEIO_DirectoryMake(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryMake(shortPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(step = 0; step < 9; step++){
+        switch(step){
+            case 1: i = FILEIO_DirectoryChange(innerPath); break;
+            case 2: i = FILEIO_DirectoryChange(dotName); break;
+            case 3: i = FILEIO_DirectoryChange(siblingPath); break;
+            case 4: i = FILEIO_DirectoryChange(upPath); break;
+            case 5: i = FILEIO_DirectoryChange(absolutePath); break;
+            case 6: i = FILEIO_DirectoryChange(siblingPath); break;
+            // Renaming a directory in the path changes the path
+            case 7: i = FILEIO_Rename(siblingPath, renamedName); break;
+            case 8: i = FILEIO_DirectoryChange(rootPath); break;
+            default: i = FILEIO_RESULT_SUCCESS; break;
+        }
+        if(i != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+        // Check each path twice, since the second call may use what the first one found
+        for(i = 0; i < 2; i++){
+            length = FILEIO_DirectoryGetCurrent(path, 40);
+            for(j = 0; path[j] != 0; j++){
+                text[j] = (char)path[j];
+            }
+            text[j] = 0;
+            if((length != strlen(expected[step])) || (strcmp(text, expected[step]) != 0)) {printf("TEST FAILED: %s\r\n", name); return false;}
+        }
+    }
+    
+    // A short buffer gets the start of the path, and the length of the whole path is returned
+    if(FILEIO_DirectoryChange(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryGetCurrent(path, 8) != 24) {printf("TEST FAILED: %s\r\n", name); return false;}
+    for(j = 0; path[j] != 0; j++){
+        text[j] = (char)path[j];
+    }
+    text[j] = 0;
+    if(strcmp(text, "A:/oute") != 0) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    if(FILEIO_DirectoryChange(rootPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(innerPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(renamedPath) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    if(FILEIO_DirectoryRemove(outerDirName) != FILEIO_RESULT_SUCCESS) {printf("TEST FAILED: %s\r\n", name); return false;}
+    
+    return true;
+}
+
 bool WindowsLFNBasenameUppercaseExtensionLowercase(void){  
     const char name[] = "WindowsLFNBasenameUppercaseExtensionLowercase";
     const uint16_t testFileName[] = {'T','E','S','T','1','.','t','x','t',0};
@@ -489,6 +1710,8 @@ TEST_FUNCTION tests[]={
     &SeekEnd, 
     &Tell,
     &Rename,
+    &RenameRecreatesEntry,
+    &CreateFileInOtherDirectory,
     &FindFilesInRoot,
     &DirectoryRemoveAfterFileDeleted,
     &DirectoryRemoveWhileNotEmpty,
@@ -499,7 +1722,29 @@ TEST_FUNCTION tests[]={
     &SeekAndWritePastEnd_2,
     &SeekAndWritePastEnd_3,
     &ErrorClear,
-    &CreateMultipleDirectoriesAtOnce
+    &CreateMultipleDirectoriesAtOnce,
+    &InterleavedWrites,
+    &RemoveReleasesClusters,
+    &SeekWithExtentMap,
+    &OverwriteWholeSectors,
+    &ReadWholeSectors,
+    &WriteWholeSectors,
+    &PreallocateContiguous,
+    &AllocationPolicyRuns,
+    &AllocationWindowAppend,
+    &DeferredFATMirroring,
+    &RemoveFragmentedFile,
+    &RemoveIncremental,
+    &TruncateFile,
+    &RewriteFile,
+    &DirectoryIndexLookups,
+    &PathCacheLookups,
+    &AliasNumericTails,
+    &FreeEntryReuse,
+    &DirectoryReadBatches,
+    &DirectoryChainMap,
+    &LongFileNameLookups,
+    &WorkingDirectoryPath
 };
 
 TEST_FUNCTION windowsSpecificTests[]={